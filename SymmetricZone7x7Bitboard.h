@@ -0,0 +1,145 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include <vector>
+
+/**
+ * a Zone7x7Bitboard that keeps all its 8 isomorphisms in sync
+ *
+ * each set() updates the same location of all isomorphisms through Zone7x7Bitboard::Isomorphisms::map(),
+ * so that the minimal isomorphism (and its id) is available without transforming the bitmaps,
+ * and each change is recorded so that undo() reverts it, e.g.,
+ *   size_t mark = board.history();
+ *   board.play(x, y, color, ko);
+ *   ... board.canonical() ...
+ *   board.undo(mark);
+ */
+class SymmetricZone7x7Bitboard {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+	using PieceType = Zone7x7Bitboard::PieceType;
+
+public:
+	inline SymmetricZone7x7Bitboard(const Zone7x7Bitboard& z = {}) {
+		Zone7x7Bitboard::Isomorphisms isoz(z.zone), isob(z.black), isow(z.white);
+		for (u32 i = 0; i < 8; i++) iso[i] = { isoz[i], isob[i], isow[i] };
+	}
+
+	/**
+	 * @return the ith isomorphism, where the 0th is the board itself
+	 */
+	inline const Zone7x7Bitboard& operator[] (u32 i) const { return iso[i]; }
+	/**
+	 * @return the board itself
+	 */
+	inline const Zone7x7Bitboard& board() const { return iso[0]; }
+	/**
+	 * get the piece at (x, y), see Zone7x7Bitboard::get()
+	 */
+	inline PieceType get(u32 x, u32 y) const { return iso[0].get(x, y); }
+
+	/**
+	 * set the piece at (x, y) for all isomorphisms, see Zone7x7Bitboard::set()
+	 * the previous piece is recorded for undo()
+	 */
+	inline void set(u32 x, u32 y, u32 type) {
+		const u32 c = y * 7 + x;
+		changes.push_back({ static_cast<unsigned char>(c), static_cast<unsigned char>(iso[0].get(x, y)) });
+		update(c, type);
+	}
+	/**
+	 * play a stone at (x, y) and remove the captured stones, see Zone7x7Bitboard::play()
+	 * all changed locations are recorded for undo()
+	 * @return
+	 *  whether the move is legal, the board is NOT modified if the move is illegal
+	 */
+	inline bool play(u32 x, u32 y, u32 color, u64& ko) {
+		Zone7x7Bitboard next = iso[0];
+		if (!next.play(x, y, color, ko)) return false;
+		assign(next);
+		return true;
+	}
+	/**
+	 * change the board to the given one, only the changed locations are updated and recorded for undo()
+	 */
+	inline void assign(const Zone7x7Bitboard& z) {
+		u64 diff = (z.zone ^ iso[0].zone) | (z.black ^ iso[0].black) | (z.white ^ iso[0].white);
+		for (; diff; diff &= diff - 1) {
+			u32 c = __builtin_ctzll(diff);
+			set(c % 7, c / 7, z.get(c % 7, c / 7));
+		}
+	}
+
+	/**
+	 * @return the number of recorded changes, which can be used as a mark of undo()
+	 */
+	inline size_t history() const { return changes.size(); }
+	/**
+	 * revert the last change
+	 */
+	inline void undo() {
+		Change last = changes.back();
+		changes.pop_back();
+		update(last.cell, last.type);
+	}
+	/**
+	 * revert the changes until there are only the given number of changes
+	 */
+	inline void undo(size_t mark) {
+		while (changes.size() > mark) undo();
+	}
+	/**
+	 * forget all recorded changes
+	 */
+	inline void commit() { changes.clear(); }
+
+public:
+	/**
+	 * find the minimal isomorphism, see Zone7x7Bitboard::normalize()
+	 * @param
+	 *  allow_slide set as true to invoke slide() for all isomorphisms, default is false
+	 * @return
+	 *  the isomorphic id number: [0, 8), the smallest one if there are multiple minimal isomorphisms
+	 */
+	inline u32 canonical_id(bool allow_slide = false) const {
+		u32 id = 0;
+		Zone7x7Bitboard min = iso[0];
+		if (allow_slide) min.slide();
+		for (u32 i = 1; i < 8; i++) {
+			Zone7x7Bitboard z = iso[i];
+			if (allow_slide) z.slide();
+			if (z < min) min = z, id = i;
+		}
+		return id;
+	}
+	/**
+	 * @return the minimal isomorphism, which equals to a copy of board() being normalize()d
+	 */
+	inline Zone7x7Bitboard canonical(bool allow_slide = false) const {
+		Zone7x7Bitboard z = iso[canonical_id(allow_slide)];
+		if (allow_slide) z.slide();
+		return z;
+	}
+
+protected:
+	inline void update(u32 c, u32 type) {
+		for (u32 i = 0; i < 8; i++) {
+			u64 mask = 1ull << Zone7x7Bitboard::Isomorphisms::map(c, i);
+			Zone7x7Bitboard& z = iso[i];
+			z.black = (type & PieceType::ZONE_BLACK) ? (z.black | mask) : (z.black & ~mask);
+			z.white = (type & PieceType::ZONE_WHITE) ? (z.white | mask) : (z.white & ~mask);
+			z.zone  = (type & PieceType::IRRELEVANT) ? (z.zone & ~mask) : (z.zone | mask);
+		}
+	}
+
+	struct Change {
+		unsigned char cell;
+		unsigned char type;
+	};
+
+	Zone7x7Bitboard iso[8];
+	std::vector<Change> changes;
+};
@@ -1,6 +1,27 @@
 #pragma once
 #include <iostream>
 #include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#include "ZoneBitboard.h"
+#if defined(ZONE7X7_STATS)
+#include "Zone7x7BitboardStats.h"
+#endif
+#if defined(ZONE7X7_BACKEND)
+#define ZONE7X7_CONCAT(a, b) ZONE7X7_CONCAT_(a, b)
+#define ZONE7X7_CONCAT_(a, b) a##b
+#define ZONE7X7_BUILTIN_BitTrick 1
+#if !ZONE7X7_CONCAT(ZONE7X7_BUILTIN_, ZONE7X7_BACKEND)
+#define ZONE7X7_ROUTED // the primitives are routed to the backend, see Zone7x7BitboardBackends
+#endif
+#endif
+
+template<> class ZoneBitboard<7>;
+using Zone7x7Bitboard = ZoneBitboard<7>;
 
 /**
  * 7x7 Go bitboard with R-Zone support
@@ -15,20 +36,48 @@
  * 1| + + + + + + + | A1 is the lowest bit
  *  +---------------+
  *    A B C D E F G
+ *
+ * this is the specialization of ZoneBitboard<7>, whose transformations are hand-tuned magic numbers for 49 bits,
+ * while the rules, the isomorphisms, and canonicalize() are shared with ZoneBitboard<N> by ZoneBitboardBase<7>
  */
-class Zone7x7Bitboard {
+template<>
+class ZoneBitboard<7> : public ZoneBitboardBase<7> {
+	friend class ZoneBitboardBase<7>;
+	friend struct Zone7x7BitboardBackends;
 public:
 	/**
-	 * common definitions
+	 * the masks of locations, see ZoneBitboardBase for the other common definitions
 	 */
-	using u64 = unsigned long long int;
-	using u32 = unsigned int;
-
 	static constexpr u64 BOARD_MASK = (-1ull >> 15);
 	static constexpr u64 ROW_MASK(u32 y) { return 0b1111111ull << (y * 7); }
 	static constexpr u64 COL_MASK(u32 x) { return 0b0000001000000100000010000001000000100000010000001ull << x; }
 	static constexpr u64 BIT_MASK(u32 x, u32 y) { return 1ull << (y * 7 + x); }
 
+	/**
+	 * parallel bits extract, i.e., gather the bits of x selected by mask into the lowest bits
+	 */
+	static inline u64 pext(u64 x, u64 mask) {
+#if defined(__BMI2__)
+		return _pext_u64(x, mask);
+#else
+		u64 z = 0;
+		for (u64 bit = 1; mask; mask &= mask - 1, bit <<= 1) z |= (x & mask & -mask) ? bit : 0;
+		return z;
+#endif
+	}
+	/**
+	 * parallel bits deposit, i.e., scatter the lowest bits of x to the bits selected by mask
+	 */
+	static inline u64 pdep(u64 x, u64 mask) {
+#if defined(__BMI2__)
+		return _pdep_u64(x, mask);
+#else
+		u64 z = 0;
+		for (u64 bit = 1; mask; mask &= mask - 1, bit <<= 1) z |= (x & bit) ? (mask & -mask) : 0;
+		return z;
+#endif
+	}
+
 public:
 	/**
 	 * bitmaps are public for easy access, be careful
@@ -46,7 +95,7 @@ public:
 	 *  black the bitmap of black stones
 	 *  white the bitmap of white stones
 	 */
-	inline constexpr Zone7x7Bitboard(u64 zone, u64 black, u64 white) : zone(zone), black(black), white(white) {}
+	inline constexpr ZoneBitboard(u64 zone, u64 black, u64 white) : zone(zone), black(black), white(white) {}
 	/**
 	 * construct a bitboard with black/white stones, with all 49 locations set as relevant
 	 * note that the provided bitmaps should NOT contain any set bits higher than the 49th bit
@@ -54,14 +103,14 @@ public:
 	 *  black the bitmap of black stones
 	 *  white the bitmap of white stones
 	 */
-	inline constexpr Zone7x7Bitboard(u64 black, u64 white) : Zone7x7Bitboard(BOARD_MASK, black, white) {}
+	inline constexpr ZoneBitboard(u64 black, u64 white) : ZoneBitboard(BOARD_MASK, black, white) {}
 	/**
 	 * construct an empty bitboard, with all 49 locations set as irrelevant
 	 * note: to construct a "relevant" empty board, use Zone7x7Bitboard(0, 0) instead
 	 */
-	inline constexpr Zone7x7Bitboard() : Zone7x7Bitboard(0, 0, 0) {}
+	inline constexpr ZoneBitboard() : ZoneBitboard(0, 0, 0) {}
 
-	inline constexpr Zone7x7Bitboard(const Zone7x7Bitboard&) = default;
+	inline constexpr ZoneBitboard(const ZoneBitboard&) = default;
 	inline constexpr Zone7x7Bitboard& operator =(const Zone7x7Bitboard&) = default;
 
 	inline constexpr Zone7x7Bitboard& operator &=(const Zone7x7Bitboard& z) { return operator =(operator &(z)); }
@@ -92,43 +141,6 @@ public:
 	inline constexpr bool operator <=(const Zone7x7Bitboard& z) const { return !(z < *this); }
 	inline constexpr bool operator >=(const Zone7x7Bitboard& z) const { return !(*this < z); }
 
-public:
-	enum PieceType {
-		ZONE_EMPTY = 0b000u, // a relevant empty location
-		ZONE_BLACK = 0b001u, // a relevant black stone
-		ZONE_WHITE = 0b010u, // a relevant white stone
-		IRRELEVANT = 0b100u, // a irrelevant piece
-	};
-	/**
-	 * get the piece at (x, y)
-	 * this function will NOT correct wrong bitmaps,
-	 * e.g., will return (ZONE_BLACK | ZONE_WHITE) when both black and white are set
-	 * @param
-	 *  x the x-axis position (A-G) in decimal number (0-6)
-	 *  y the y-axis position (1-7) in decimal number (0-6)
-	 * @return
-	 *  the piece at (x, y) in PieceType format
-	 */
-	inline constexpr PieceType get(u32 x, u32 y) const {
-		u64 mask = 1ull << (y * 7 + x);
-		return static_cast<PieceType>((black & mask ? 1 : 0) | (white & mask ? 2 : 0) | (zone & mask ? 0 : 4));
-	}
-	/**
-	 * set the piece at (x, y)
-	 * this function will NOT correct wrong arguments,
-	 * e.g., will set both black and white for (ZONE_BLACK | ZONE_WHITE)
-	 * @param
-	 *  x the x-axis position (A-G) in decimal number (0-6)
-	 *  y the y-axis position (1-7) in decimal number (0-6)
-	 *  type the PieceType to be set
-	 */
-	inline constexpr void set(u32 x, u32 y, u32 type) {
-		u64 mask = 1ull << (y * 7 + x);
-		black = (type & PieceType::ZONE_BLACK) ? (black | mask) : (black & ~mask);
-		white = (type & PieceType::ZONE_WHITE) ? (white | mask) : (white & ~mask);
-		zone  = (type & PieceType::IRRELEVANT) ? (zone & ~mask) : (zone | mask);
-	}
-
 public:
 	/**
 	 * transpose this board (reflection line is A1 - G7)
@@ -154,16 +166,6 @@ public:
 		black = mirror(black);
 		white = mirror(white);
 	}
-	/**
-	 * transform this board to a specific isomorphic form
-	 * @param
-	 *  i the isomorphic id number: [0, 8)
-	 */
-	inline constexpr void transform(u32 i) {
-		zone = Isomorphisms::transform(zone, i);
-		black = Isomorphisms::transform(black, i);
-		white = Isomorphisms::transform(white, i);
-	}
 
 public:
 	/**
@@ -213,17 +215,13 @@ public:
 	 * +---------------+     +---------------+   +---------------+     +---------------+
 	 */
 	inline constexpr void slide() {
-		u32 offset = 0;
-		if ((zone & 0b1111111000000000000000000000000000000000000000000ull) == 0) {
-			offset += ((__builtin_ctzll(zone | (1ull << 49)) / 7 ?: 1) - 1) * 7;
-		}
-		if ((zone & 0b1000000100000010000001000000100000010000001000000ull) == 0) {
-			u64 squz = zone;
-			squz = squz | (squz >> 21);
-			squz = squz | (squz >> 14);
-			squz = squz | (squz >> 7);
-			offset += ((__builtin_ctzll(squz | (0b10000000)) ?: 1) - 1);
+		const u32 offset = slide_offset(zone);
+#if defined(ZONE7X7_STATS)
+		if (!__builtin_is_constant_evaluated()) {
+			Zone7x7BitboardStats::add(Zone7x7BitboardStats::SLIDE);
+			if (offset && zone) Zone7x7BitboardStats::add(Zone7x7BitboardStats::SLIDE_SHIFTED);
 		}
+#endif
 		*this >>= offset;
 	}
 
@@ -234,16 +232,170 @@ public:
 	 *  allow_slide set as true to invoke slide() for all isomorphisms, default is false
 	 */
 	inline constexpr void normalize(bool allow_slide = false) {
-		Isomorphisms isoz = zone, isob = black, isow = white;
-		if (allow_slide) slide();
-		for (u32 i = 1; i < 8; i++) {
-			Zone7x7Bitboard iso(isoz[i], isob[i], isow[i]);
-			if (allow_slide) iso.slide();
-			if (iso < *this) *this = iso;
+		canonicalize(allow_slide);
+	}
+#if defined(ZONE7X7_STATS)
+	/**
+	 * normalize this board to the minimal isomorphisms, see ZoneBitboardBase::canonicalize(),
+	 * which is hidden by this one to count the calls, see Zone7x7BitboardStats
+	 */
+	inline constexpr Transformation canonicalize(bool allow_slide = false) {
+		const Zone7x7Bitboard origin = *this;
+		const Transformation t = ZoneBitboardBase::canonicalize(allow_slide);
+		if (!__builtin_is_constant_evaluated()) record(origin, allow_slide, t);
+		return t;
+	}
+#endif
+	/**
+	 * normalize an array of boards, the result of each board is identical to normalize()
+	 * boards are processed in groups of Lanes::width with AVX-512 or AVX2 when available,
+	 * and the rest (or all of them, when no vector extension is enabled) are normalized one by one
+	 * note that all boards are normalized one by one if ZONE7X7_STATS is defined, so that all of them are counted
+	 * @param
+	 *  boards      the boards to be normalized in place
+	 *  n           the number of boards
+	 *  allow_slide set as true to invoke slide() for all isomorphisms, default is false
+	 */
+	static inline void normalize_batch(Zone7x7Bitboard* boards, size_t n, bool allow_slide = false) {
+		size_t i = 0;
+#if (defined(__AVX512F__) || defined(__AVX2__)) && !defined(ZONE7X7_STATS)
+		for (; i + Lanes::width <= n; i += Lanes::width) {
+			Lanes::vec zone, black, white;
+			for (u32 k = 0; k < Lanes::width; k++) {
+				zone[k] = boards[i + k].zone;
+				black[k] = boards[i + k].black;
+				white[k] = boards[i + k].white;
+			}
+			Lanes::normalize(zone, black, white, allow_slide);
+			for (u32 k = 0; k < Lanes::width; k++) {
+				boards[i + k] = {zone[k], black[k], white[k]};
+			}
+		}
+#endif
+		for (; i < n; i++) boards[i].normalize(allow_slide);
+	}
+	/**
+	 * normalize an array of boards stored as separated bitmap columns, see normalize_batch() above
+	 * @param
+	 *  zone        the bitmaps of R-zone
+	 *  black       the bitmaps of black stones
+	 *  white       the bitmaps of white stones
+	 *  n           the number of boards
+	 *  allow_slide set as true to invoke slide() for all isomorphisms, default is false
+	 */
+	static inline void normalize_batch(u64* zone, u64* black, u64* white, size_t n, bool allow_slide = false) {
+		size_t i = 0;
+#if (defined(__AVX512F__) || defined(__AVX2__)) && !defined(ZONE7X7_STATS)
+		for (; i + Lanes::width <= n; i += Lanes::width) {
+			Lanes::vec z, b, w;
+			__builtin_memcpy(&z, zone + i, sizeof(z));
+			__builtin_memcpy(&b, black + i, sizeof(b));
+			__builtin_memcpy(&w, white + i, sizeof(w));
+			Lanes::normalize(z, b, w, allow_slide);
+			__builtin_memcpy(zone + i, &z, sizeof(z));
+			__builtin_memcpy(black + i, &b, sizeof(b));
+			__builtin_memcpy(white + i, &w, sizeof(w));
+		}
+#endif
+		for (; i < n; i++) {
+			Zone7x7Bitboard z(zone[i], black[i], white[i]);
+			z.normalize(allow_slide);
+			zone[i] = z.zone;
+			black[i] = z.black;
+			white[i] = z.white;
 		}
 	}
 
 protected:
+#if defined(ZONE7X7_STATS)
+	/**
+	 * count a canonicalize() call, see Zone7x7BitboardStats
+	 * @param
+	 *  origin      the board before canonicalize()
+	 *  allow_slide the argument of canonicalize()
+	 *  t           the applied transformation
+	 */
+	inline void record(const Zone7x7Bitboard& origin, bool allow_slide, const Transformation& t) const {
+		using Stats = Zone7x7BitboardStats;
+		Isomorphisms isoz = origin.zone;
+		u32 shift[8] = {}, ties = 0; // the minimal isomorphisms of zone, as canonicalize()
+		for (u32 i = 0; i < 8; i++) {
+			shift[i] = allow_slide ? slide_offset(isoz[i]) : 0;
+			ties |= (isoz[i] >> shift[i] == zone) ? (1u << i) : 0;
+		}
+		const u32 best = t.iso;
+		Stats::add(allow_slide ? Stats::NORMALIZE_SLIDE : Stats::NORMALIZE);
+		Stats::add(Stats::ISO + best);
+		Stats::add(Stats::SYMMETRY + __builtin_ctz(__builtin_popcount(ties)));
+		for (u32 rest = ties & ~(1u << best); rest; rest &= rest - 1) {
+			u32 i = __builtin_ctz(rest);
+			bool same = (Isomorphisms::transform(origin.black, i) >> shift[i] == black) & (Isomorphisms::transform(origin.white, i) >> shift[i] == white);
+			if (same) {
+				Stats::add(Stats::SELF_SYMMETRIC);
+				break;
+			}
+		}
+		if (allow_slide && zone) {
+			Stats::add(Stats::SHIFT_ROWS + shift[best] / 7);
+			Stats::add(Stats::SHIFT_COLUMNS + shift[best] % 7);
+		}
+	}
+#endif
+#if defined(ZONE7X7_ROUTED)
+	/**
+	 * the primitives of the backend selected by ZONE7X7_BACKEND, which are defined in Zone7x7BitboardBackends.h
+	 */
+	static inline u32 backend_slide_offset(u64 zone);
+	static inline u64 backend_transpose(u64 x);
+	static inline u64 backend_flip(u64 x);
+	static inline u64 backend_mirror(u64 x);
+#endif
+	/**
+	 * the primitives, which are routed to the backend selected at compile time, if any,
+	 * except when they are evaluated at compile time; otherwise they are the bit tricks below
+	 */
+	static inline constexpr u32 slide_offset(u64 zone) {
+#if defined(ZONE7X7_ROUTED)
+		if (!__builtin_is_constant_evaluated()) return backend_slide_offset(zone);
+#endif
+		return bittrick_slide_offset(zone);
+	}
+	static inline constexpr u64 transpose(u64 x) {
+#if defined(ZONE7X7_ROUTED)
+		if (!__builtin_is_constant_evaluated()) return backend_transpose(x);
+#endif
+		return bittrick_transpose(x);
+	}
+	static inline constexpr u64 flip(u64 x) {
+#if defined(ZONE7X7_ROUTED)
+		if (!__builtin_is_constant_evaluated()) return backend_flip(x);
+#endif
+		return bittrick_flip(x);
+	}
+	static inline constexpr u64 mirror(u64 x) {
+#if defined(ZONE7X7_ROUTED)
+		if (!__builtin_is_constant_evaluated()) return backend_mirror(x);
+#endif
+		return bittrick_mirror(x);
+	}
+
+	/**
+	 * calculate the right shift of slide() for the given zone
+	 */
+	static inline constexpr u32 bittrick_slide_offset(u64 zone) {
+		u32 offset = 0;
+		if ((zone & 0b1111111000000000000000000000000000000000000000000ull) == 0) {
+			offset += ((__builtin_ctzll(zone | (1ull << 49)) / 7 ?: 1) - 1) * 7;
+		}
+		if ((zone & 0b1000000100000010000001000000100000010000001000000ull) == 0) {
+			u64 squz = zone;
+			squz = squz | (squz >> 21);
+			squz = squz | (squz >> 14);
+			squz = squz | (squz >> 7);
+			offset += ((__builtin_ctzll(squz | (0b10000000)) ?: 1) - 1);
+		}
+		return offset;
+	}
 	/**
 	 * 	transpose the given 49-bit board
 	 * 	(1)                             (2)                             (3)                             (4)                             (5)
@@ -255,7 +407,7 @@ protected:
 	 * 	H I J K L M N   1 0 * 0 1 0 *   B I P K F M T   0 0 0 * 0 0 0   B I P W F M T   0 0 0 0 0 0 0   B I P W F M T   0 0 0 0 * * *   B I P W d k r
 	 * 	A B C D E F G   0 * 0 0 0 * 0   A H C D E L G   0 0 * 0 0 0 *   A H O D E L S   0 0 0 * 0 0 0   A H O V E L S   0 0 0 0 * * *   A H O V c j q
 	 */
-	static inline constexpr u64 transpose(u64 x) {
+	static inline constexpr u64 bittrick_transpose(u64 x) {
 		u64 z = x; // (1)
 		z = z ^ (z << 6);
 		z = z & 0b0100010001000100010000000100010001000100010000000ull;
@@ -303,7 +455,7 @@ protected:
 	 * 	M M M M M M L L   F F F F F F E E
 	 * 	K K K K K K K M   G G G G G G G F
 	 */
-	static inline constexpr u64 flip(u64 x) {
+	static inline constexpr u64 bittrick_flip(u64 x) {
 		u64 p = x; // (1)
 		p = p & 0x00000007f0003fffull; // (2)
 		p = p * 0x0200080000000002ull >> 15; // (3)
@@ -331,7 +483,7 @@ protected:
 	 * 	H I J K L M N   0 0 0 K 0 0 0   0 0 0 K J 0 0   0 0 L K J 0 0   0 0 L K J I 0   0 M L K J I 0   0 M L K J I H   N M L K J I H
 	 * 	A B C D E F G   0 0 0 D 0 0 0   0 0 0 D C 0 0   0 0 E D C 0 0   0 0 E D C B 0   0 F E D C B 0   0 F E D C B A   G F E D C B A
 	 */
-	static inline constexpr u64 mirror(u64 x) {
+	static inline constexpr u64 bittrick_mirror(u64 x) {
 		u64 z = (x & 0b0001000000100000010000001000000100000010000001000ull); // (1)
 		z = z | (x & 0b0000100000010000001000000100000010000001000000100ull) << 2; // (2)
 		z = z | (x & 0b0010000001000000100000010000001000000100000010000ull) >> 2; // (3)
@@ -341,50 +493,215 @@ protected:
 		z = z | (x & 0b1000000100000010000001000000100000010000001000000ull) >> 6; // (7)
 		return z;
 	}
+
+protected:
+#if defined(__AVX512F__) || defined(__AVX2__)
 	/**
-	 * generate all isomorphisms of a given 64-bit 7x7 board by flip/transpose consecutively
-	 * note that the output of transform(x, i) is the ith isomorphism in iso[], i.e., Isomorphisms(x)[i]
-	 * transform(x, i) may be more efficient when only several isomorphisms are needed
-	 */
-	struct Isomorphisms {
-		u64 iso[8];
-		inline constexpr Isomorphisms(u64 x) : iso{} {
-			iso[0] = x;
-			iso[1] = flip(iso[0]);
-			iso[2] = transpose(iso[1]);
-			iso[3] = flip(iso[2]);
-			iso[4] = transpose(iso[3]);
-			iso[5] = flip(iso[4]);
-			iso[6] = transpose(iso[5]);
-			iso[7] = flip(iso[6]);
+	 * lane-wise transformations for normalize_batch(), each lane holds a bitmap of a different board
+	 * the operations are the same as the scalar ones, except that the multiplications in flip()
+	 * are expanded into shifts and adds since AVX2 has no 64-bit multiplication
+	 */
+	struct Lanes {
+#if defined(__AVX512F__)
+		static constexpr u32 width = 8;
+#else
+		static constexpr u32 width = 4;
+#endif
+		typedef u64 vec __attribute__((vector_size(width * sizeof(u64))));
+
+		static inline vec transpose(vec x) {
+			vec z = x;
+			z = z ^ (z << 6);
+			z = z & 0b0100010001000100010000000100010001000100010000000ull;
+			x = z = x ^ (z | (z >> 6));
+			z = z ^ (z << 12);
+			z = z & 0b0010001000100000000000000010001000100000000000000ull;
+			x = z = x ^ (z | (z >> 12));
+			z = z ^ (z << 18);
+			z = z & 0b0001000000000000000000000001000000000000000000000ull;
+			x = z = x ^ (z | (z >> 18));
+			z = z ^ (z << 24);
+			z = z & 0b0000111000011100001110000000000000000000000000000ull;
+			x = x ^ (z | (z >> 24));
+			return x;
+		}
+		static inline vec flip(vec x) {
+			vec p = x;
+			p = p & 0x00000007f0003fffull;
+			p = ((p << 57) + (p << 43) + (p << 1)) >> 15; // p * 0x0200080000000002ull >> 15
+			p = p & 0x0001fff8001fc000ull;
+
+			vec q = x;
+			q = q & 0x0001fff8001fc000ull;
+			q = q ^ p;
+
+			p = q >> 14;
+			p = ((p << 57) + (p << 15) + (p << 1)) >> 29; // p * 0x0200000000008002ull >> 29
+			p = p & 0x00000007f0003fffull;
+
+			vec z = p | q;
+			return x ^ z;
 		}
-		static inline constexpr u64 transform(u64 x, u32 i) {
-			switch (i % 8) {
-			default:
-			case 0: return x;
-			case 6: x = transpose(x);
-			case 1: x = flip(x);
-			        return x;
-			case 4: x = flip(x);
-			case 5: x = mirror(x);
-			        return x;
-			case 3: x = mirror(x);
-			case 2: x = flip(x);
-			case 7: x = transpose(x);
-			        return x;
+		static inline vec slide(vec zone) {
+			// count the empty rows from the bottom and the empty columns from the left
+			vec rows = zone & 0, cols = zone & 0, none = (zone | ~zone);
+			for (u32 y = 0; y < 7; y++) {
+				none &= (vec)((zone & ROW_MASK(y)) == 0);
+				rows -= none;
+			}
+			vec squz = zone;
+			squz = squz | (squz >> 21);
+			squz = squz | (squz >> 14);
+			squz = squz | (squz >> 7);
+			none = (zone | ~zone);
+			for (u32 x = 0; x < 7; x++) {
+				none &= (vec)((squz & BIT_MASK(x, 0)) == 0);
+				cols -= none;
+			}
+			// same as slide(), keep one empty row (column) unless the zone touches the opposite border
+			vec offset = zone & 0;
+			offset += ((zone & ROW_MASK(6)) == 0) & ((rows > 1) ? (rows - 1) * 7 : 0);
+			offset += ((zone & COL_MASK(6)) == 0) & ((cols > 1) ? (cols - 1) : 0);
+			return offset;
+		}
+		static inline void normalize(vec& zone, vec& black, vec& white, bool allow_slide) {
+			vec isoz = zone, isob = black, isow = white;
+			if (allow_slide) {
+				vec offset = slide(zone);
+				zone >>= offset;
+				black >>= offset;
+				white >>= offset;
+			}
+			for (u32 i = 1; i < 8; i++) {
+				if (i & 1) {
+					isoz = flip(isoz);
+					isob = flip(isob);
+					isow = flip(isow);
+				} else {
+					isoz = transpose(isoz);
+					isob = transpose(isob);
+					isow = transpose(isow);
+				}
+				vec z = isoz, b = isob, w = isow;
+				if (allow_slide) {
+					vec offset = slide(z);
+					z >>= offset;
+					b >>= offset;
+					w >>= offset;
+				}
+				vec less = (z != zone) ? (vec)(z < zone) : ((b != black) ? (vec)(b < black) : (vec)(w < white));
+				zone = less ? z : zone;
+				black = less ? b : black;
+				white = less ? w : white;
 			}
 		}
-		inline constexpr u64& operator[] (u32 i) { return iso[i]; }
-		inline constexpr const u64& operator[] (u32 i) const { return iso[i]; }
-		inline constexpr u64* begin() { return iso; }
-		inline constexpr const u64* begin() const { return iso; }
-		inline constexpr u64* end() { return iso + 8; }
-		inline constexpr const u64* end() const { return iso + 8; }
 	};
+#endif
 
 public:
 	/**
-	 * print the given board to the given ostream
+	 * the layout of render()
+	 */
+	struct Layout {
+		bool axis;         // whether to print axis labels (A-G, 1-7)
+		bool border;       // whether to print the borders, the bold ones are the R-zone borders
+		u32 columns;       // the number of boards per line of the grid
+		const char* gap;   // the separator between adjacent boards
+		const char* arrow; // the separator at the middle row (row 4) instead of gap, e.g., " >>> ", or nullptr for gap
+	};
+	/**
+	 * @return the default layout, a board per line with axis labels and borders
+	 */
+	static inline constexpr Layout default_layout() { return { true, true, 1, "     ", nullptr }; }
+
+	/**
+	 * render the given boards as a grid of text, e.g., with layout { true, true, 2, "     ", " >>> " },
+	 *  +---------------+      +---------------+
+	 * 7|               |     7|               |
+	 * ...                      ...
+	 * 4|               | >>> 4|               |
+	 * ...                      ...
+	 *    A B C D E F G          A B C D E F G
+	 * the glyphs of each row are copied from tables indexed by its 7-bit slices of zone, black, and white,
+	 * which are generated at compile time
+	 * @param
+	 *  out    the buffer to write, should have at least render_size(n, layout) bytes
+	 *  boards the boards to be rendered
+	 *  n      the number of boards
+	 *  layout the layout of the grid
+	 * @return
+	 *  the end of the written text
+	 */
+	template<typename T = void>
+	static inline char* render(char* out, const Zone7x7Bitboard* boards, size_t n, const Layout& layout) {
+		const RenderTables& t = RenderStatic<T>::tables; // instantiated after this class is complete
+		const size_t gap = std::strlen(layout.gap), arrow = layout.arrow ? std::strlen(layout.arrow) : gap;
+		const char* middle = layout.arrow ? layout.arrow : layout.gap;
+		const u32 columns = std::max(layout.columns, 1u);
+
+		for (size_t first = 0; first < n; first += columns) {
+			const size_t last = std::min<size_t>(first + columns, n);
+			for (int line = layout.border ? 0 : 1; line < (layout.border ? 9 : 8); line++) {
+				for (size_t i = first; i < last; i++) {
+					const Zone7x7Bitboard& z = boards[i];
+					if (i != first) {
+						out = static_cast<char*>(std::memcpy(out, line == 4 ? middle : layout.gap, line == 4 ? arrow : gap)) + (line == 4 ? arrow : gap);
+					}
+					if (line == 0 || line == 8) { // top or bottom border
+						const RenderTables::Text<56>& edge = t.edge[line / 8][(z.zone >> (line == 0 ? 42 : 0)) & 127];
+						if (layout.axis) *(out++) = ' ';
+						std::memcpy(out, edge.data, sizeof(edge.data));
+						out += edge.size;
+						continue;
+					}
+					const u32 y = 7 - line, shift = y * 7;
+					const u32 zone = (z.zone >> shift) & 127, black = (z.black >> shift) & 127, white = (z.white >> shift) & 127;
+					const u32 other = (~zone | (black & white)) & 127; // the irrelevant pieces (and invalid ones)
+					const u32 code = t.spread[black | other] | (t.spread[white | other] << 1);
+					if (layout.axis) *(out++) = '1' + y;
+					out = vertical(out, layout.border ? 2 + (zone & 1) : -1);
+					*(out++) = ' ';
+					std::memcpy(out, t.quad[code & 255].data, sizeof(t.quad[0].data));
+					out += t.quad[code & 255].size;
+					std::memcpy(out, t.triple[code >> 8].data, sizeof(t.triple[0].data));
+					out += t.triple[code >> 8].size;
+					out = vertical(out, layout.border ? 2 + (zone >> 6) : -1);
+				}
+				*(out++) = '\n';
+			}
+			if (layout.axis) {
+				for (size_t i = first; i < last; i++) {
+					if (i != first) out = static_cast<char*>(std::memcpy(out, layout.gap, gap)) + gap;
+					out = static_cast<char*>(std::memcpy(out, "   A B C D E F G  ", 18)) + 18;
+				}
+				*(out++) = '\n';
+			}
+		}
+		return out;
+	}
+	/**
+	 * render the given boards with the default layout, see render(out, boards, n, layout)
+	 */
+	static inline char* render(char* out, const Zone7x7Bitboard* boards, size_t n) {
+		return render(out, boards, n, default_layout());
+	}
+	/**
+	 * render this board, see render(out, boards, n, layout)
+	 */
+	inline char* render(char* out, const Layout& layout) const { return render(out, this, 1, layout); }
+	inline char* render(char* out) const { return render(out, this, 1, default_layout()); }
+	/**
+	 * @return the buffer size required by render(out, boards, n, layout)
+	 */
+	static inline size_t render_size(size_t n, const Layout& layout) {
+		const size_t columns = std::max(layout.columns, 1u), lines = 10 * ((n + columns - 1) / columns);
+		const size_t separator = std::max(std::strlen(layout.gap), layout.arrow ? std::strlen(layout.arrow) : 0);
+		return lines * (std::min(n, columns) * (57 + separator) + 1) + 64; // with the slack of fixed-size copies
+	}
+	static inline size_t render_size(size_t n) { return render_size(n, default_layout()); }
+
+	/**
+	 * print the given board to the given ostream with a single write, see render()
 	 * @param
 	 *  out the ostream to print
 	 *  z   the board to be printed
@@ -392,46 +709,89 @@ public:
 	 *  the given ostream (out)
 	 */
 	friend std::ostream& operator <<(std::ostream& out, const Zone7x7Bitboard& z) {
-		const bool axis = true; // whether to print axis labels (A-G, 1-7)
+		char buf[1024];
+		return out.write(buf, z.render(buf) - buf);
+	}
 
+protected:
+	/**
+	 * the tables of render(), see generate_render_tables()
+	 */
+	struct RenderTables {
+		template<size_t N> struct Text {
+			char data[N];
+			u32 size;
+		};
+		u32 spread[128];       // the 7 bits spread to the even bits, i.e., bit i to bit (i * 2)
+		Text<16> quad[256];    // the glyphs of 4 locations, each location has 2 bits: 0 empty, 1 black, 2 white, 3 irrelevant
+		Text<12> triple[64];   // the glyphs of 3 locations, as quad[]
+		Text<56> edge[2][128]; // the top and the bottom borders of the zone bits of the top and the bottom rows
+	};
+	static inline constexpr void append(char* data, u32& size, const char* text) {
+		while (*text) data[size++] = *(text++);
+	}
+	static inline constexpr RenderTables generate_render_tables() {
 		const char* symbol[] = {"\u00B7", "\u25CF", "\u25CB", "\u00A0"}; // empty  black  white  irrelevant
 		const char* corner[] = {"\u250C", "\u250F", "\u2510", "\u2513",  // top-left{normal, bold}  top-right{normal, bold}
 		                        "\u2514", "\u2517", "\u2518", "\u251B"}; // bottom-left{normal, bold}  bottom-right{normal, bold}
-		const char* border[] = {"\u2500", "\u2501", "\u2502", "\u2503"}; // horizontal{normal, bold}  vertical{normal, bold}
+		const char* border[] = {"\u2500", "\u2501"}; // horizontal{normal, bold}
 
-		// gather r-zone info
-		bool zone[7][7] = {};
-		for (int y = 0; y < 7; y++) {
-			for (int x = 0; x < 7; x++) {
-				zone[x][y] = (z.get(x, y) & PieceType::IRRELEVANT) != PieceType::IRRELEVANT;
-			}
+		RenderTables t = {};
+		for (u32 r = 0; r < 128; r++) {
+			for (u32 i = 0; i < 7; i++) t.spread[r] |= ((r >> i) & 1) << (i * 2);
 		}
-
-		// print top border
-		out << (axis ? " " : "") << corner[0 + zone[0][6]];
-		for (int last = zone[0][6], x = 0; x < 7; last = zone[x++][6]) {
-			out << border[0 + (zone[x][6] | last)] << border[0 + zone[x][6]];
+		for (u32 code = 0; code < 256; code++) {
+			for (u32 i = 0; i < 4; i++) {
+				append(t.quad[code].data, t.quad[code].size, symbol[(code >> (i * 2)) & 3]);
+				append(t.quad[code].data, t.quad[code].size, " ");
+				if (i == 3 || code >= 64) continue;
+				append(t.triple[code].data, t.triple[code].size, symbol[(code >> (i * 2)) & 3]);
+				append(t.triple[code].data, t.triple[code].size, " ");
+			}
 		}
-		out << border[0 + zone[6][6]] << corner[2 + zone[6][6]] << std::endl;
-
-		// print left border, pieces, and right border (row by row)
-		for (int y = 6; y >= 0; y--) {
-			if (axis) out << char('1' + y);
-			out << border[2 + zone[0][y]] << " ";
-			for (int x = 0; x < 7; x++) {
-				out << symbol[std::min<u32>(z.get(x, y), 3)] << " ";
+		for (u32 k = 0; k < 2; k++) {
+			for (u32 r = 0; r < 128; r++) {
+				RenderTables::Text<56>& edge = t.edge[k][r];
+				append(edge.data, edge.size, corner[k * 4 + 0 + (r & 1)]);
+				for (u32 last = r & 1, x = 0; x < 7; last = (r >> x++) & 1) {
+					append(edge.data, edge.size, border[((r >> x) & 1) | last]);
+					append(edge.data, edge.size, border[(r >> x) & 1]);
+				}
+				append(edge.data, edge.size, border[r >> 6]);
+				append(edge.data, edge.size, corner[k * 4 + 2 + (r >> 6)]);
 			}
-			out << border[2 + zone[6][y]] << std::endl;
 		}
+		return t;
+	}
+	template<typename = void> struct RenderStatic { static constexpr RenderTables tables = generate_render_tables(); };
 
-		// print bottom border
-		out << (axis ? " " : "") << corner[4 + zone[0][0]];
-		for (int last = zone[0][0], x = 0; x < 7; last = zone[x++][0]) {
-			out << border[0 + (zone[x][0] | last)] << border[0 + zone[x][0]];
+	/**
+	 * write a vertical border, {normal, bold} for 2 and 3, or a space for others
+	 */
+	static inline char* vertical(char* out, int type) {
+		if (type < 2) {
+			*(out++) = ' ';
+			return out;
 		}
-		out << border[0 + zone[6][0]] << corner[6 + zone[6][0]] << std::endl;
-		if (axis) out << "   A B C D E F G  " << std::endl;
-
-		return out;
+		out[0] = '\xE2', out[1] = '\x94', out[2] = type == 2 ? '\x82' : '\x83'; // U+2502 or U+2503
+		return out + 3;
 	}
 };
+
+template<typename T>
+constexpr Zone7x7Bitboard::RenderTables Zone7x7Bitboard::RenderStatic<T>::tables;
+
+static_assert(Zone7x7Bitboard::Isomorphisms::verify(), "the transformations disagree with the dihedral group");
+static_assert(ZoneBitboard<5>::Isomorphisms::verify(), "the transformations disagree with the dihedral group");
+static_assert(ZoneBitboard<9>::Isomorphisms::verify(), "the transformations disagree with the dihedral group");
+static_assert(zone_bitboard_check<5>() && zone_bitboard_check<7>(), "Zone7x7Bitboard differs from ZoneBitboard<N>");
+
+namespace std {
+template<> struct hash<Zone7x7Bitboard> {
+	inline constexpr size_t operator ()(const Zone7x7Bitboard& z) const { return z.hash(); }
+};
+}
+
+#if defined(ZONE7X7_ROUTED)
+#include "Zone7x7BitboardBackends.h"
+#endif
@@ -0,0 +1,164 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include <vector>
+#include <cstdlib>
+#include <new>
+
+/**
+ * a structure-of-arrays container of Zone7x7Bitboard
+ *
+ * the bitmaps are stored as three separated columns (zone, black, white), each is 64-byte aligned,
+ * so that the columns can be streamed by sort() and processed by SIMD kernels such as normalize_batch()
+ */
+class Zone7x7BitboardArray {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+
+	template<typename T>
+	struct AlignedAllocator {
+		using value_type = T;
+		static constexpr size_t alignment = 64;
+		inline constexpr AlignedAllocator() = default;
+		template<typename U> inline constexpr AlignedAllocator(const AlignedAllocator<U>&) {}
+		inline T* allocate(size_t n) {
+			void* p = nullptr;
+			if (posix_memalign(&p, alignment, n * sizeof(T)) != 0) throw std::bad_alloc();
+			return static_cast<T*>(p);
+		}
+		inline void deallocate(T* p, size_t) { free(p); }
+		template<typename U> inline constexpr bool operator ==(const AlignedAllocator<U>&) const { return true; }
+		template<typename U> inline constexpr bool operator !=(const AlignedAllocator<U>&) const { return false; }
+	};
+	using column = std::vector<u64, AlignedAllocator<u64>>;
+
+public:
+	/**
+	 * columns are public for easy access, be careful to keep their sizes equal
+	 */
+	column zone;  // bitmaps of R-zone
+	column black; // bitmaps of black stones
+	column white; // bitmaps of white stones
+
+public:
+	inline Zone7x7BitboardArray(size_t n = 0) : zone(n), black(n), white(n) {}
+	template<typename It>
+	inline Zone7x7BitboardArray(It first, It last) { for (; first != last; ++first) push_back(*first); }
+
+	inline size_t size() const { return zone.size(); }
+	inline bool empty() const { return zone.empty(); }
+	inline void reserve(size_t n) { zone.reserve(n); black.reserve(n); white.reserve(n); }
+	inline void resize(size_t n) { zone.resize(n); black.resize(n); white.resize(n); }
+	inline void clear() { zone.clear(); black.clear(); white.clear(); }
+
+	inline void push_back(const Zone7x7Bitboard& z) {
+		zone.push_back(z.zone);
+		black.push_back(z.black);
+		white.push_back(z.white);
+	}
+	inline Zone7x7Bitboard operator[] (size_t i) const { return {zone[i], black[i], white[i]}; }
+	inline void set(size_t i, const Zone7x7Bitboard& z) {
+		zone[i] = z.zone;
+		black[i] = z.black;
+		white[i] = z.white;
+	}
+
+public:
+	/**
+	 * normalize all boards, see Zone7x7Bitboard::normalize_batch()
+	 * @param
+	 *  allow_slide set as true to invoke slide() for all isomorphisms, default is false
+	 */
+	inline void normalize(bool allow_slide = false) {
+		Zone7x7Bitboard::normalize_batch(zone.data(), black.data(), white.data(), size(), allow_slide);
+	}
+
+	/**
+	 * sort all boards in ascending order, the order is exactly the same as Zone7x7Bitboard::operator<()
+	 * this is a LSD radix sort with 11-bit digits over (white, black, zone), i.e., 6 digits per column,
+	 * where a digit that is identical for all boards is skipped (e.g., the bits higher than the 49th bit)
+	 */
+	inline void sort() {
+		constexpr u32 bits = 11, radix = 1u << bits, digits = (64 + bits - 1) / bits;
+		const size_t n = size();
+		if (n < 2) return;
+
+		// gather the histograms of all digits with a single pass
+		std::vector<size_t> count(3 * digits * radix);
+		const u64* key[3] = { white.data(), black.data(), zone.data() };
+		for (u32 k = 0; k < 3; k++) {
+			size_t* hist = count.data() + k * digits * radix;
+			for (size_t i = 0; i < n; i++) {
+				u64 x = key[k][i];
+				for (u32 d = 0; d < digits; d++) {
+					hist[d * radix + ((x >> (d * bits)) & (radix - 1))]++;
+				}
+			}
+		}
+
+		column buf[3] = { column(n), column(n), column(n) };
+		u64* src[3] = { white.data(), black.data(), zone.data() };
+		u64* dst[3] = { buf[0].data(), buf[1].data(), buf[2].data() };
+		u32 passes = 0;
+		for (u32 k = 0; k < 3; k++) {
+			for (u32 d = 0; d < digits; d++) {
+				size_t* hist = count.data() + (k * digits + d) * radix;
+				const u32 shift = d * bits;
+				if (hist[(src[k][0] >> shift) & (radix - 1)] == n) continue; // trivial digit
+
+				for (size_t offset = 0, r = 0; r < radix; r++) {
+					size_t c = hist[r];
+					hist[r] = offset;
+					offset += c;
+				}
+				for (size_t i = 0; i < n; i++) {
+					size_t j = hist[(src[k][i] >> shift) & (radix - 1)]++;
+					dst[0][j] = src[0][i];
+					dst[1][j] = src[1][i];
+					dst[2][j] = src[2][i];
+				}
+				std::swap(src[0], dst[0]);
+				std::swap(src[1], dst[1]);
+				std::swap(src[2], dst[2]);
+				passes++;
+			}
+		}
+		if (passes & 1) {
+			white.swap(buf[0]);
+			black.swap(buf[1]);
+			zone.swap(buf[2]);
+		}
+	}
+
+	/**
+	 * remove consecutive duplicate boards in place, i.e., std::unique() for all columns
+	 * @return
+	 *  the number of remaining boards
+	 */
+	inline size_t unique() {
+		const size_t n = size();
+		size_t m = n ? 1 : 0;
+		for (size_t i = 1; i < n; i++) {
+			bool same = (zone[i] == zone[m - 1]) & (black[i] == black[m - 1]) & (white[i] == white[m - 1]);
+			zone[m] = zone[i];
+			black[m] = black[i];
+			white[m] = white[i];
+			m += same ? 0 : 1;
+		}
+		resize(m);
+		return m;
+	}
+
+	/**
+	 * sort all boards and remove duplicate boards
+	 * @return
+	 *  the number of remaining boards
+	 */
+	inline size_t dedup() {
+		sort();
+		return unique();
+	}
+};
@@ -0,0 +1,224 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include <random>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(ZONE7X7_BACKEND)
+#define ZONE7X7_PDEP_BMI2 1 // the backends that rely on pext/pdep
+#if ZONE7X7_CONCAT(ZONE7X7_PDEP_, ZONE7X7_BACKEND)
+#if !defined(__BMI2__)
+#warning "ZONE7X7_BACKEND=BMI2 is selected for a target without BMI2, the primitives will fault on such CPUs"
+#elif defined(__znver1__) || defined(__znver2__)
+#warning "ZONE7X7_BACKEND=BMI2 is selected for Zen 1/2, whose pext/pdep are microcoded and slower than BitTrick"
+#endif
+#endif
+#endif
+
+/**
+ * alternative implementations of the primitives of Zone7x7Bitboard
+ *
+ * BitTrick: the delta-swap and multiplication sequences of Zone7x7Bitboard itself
+ * Lookup:   row-wise tables of 128 entries (7 bits per row), generated at compile time
+ * BMI2:     pext/pdep gathering and scattering of rows and columns
+ *
+ * the backend is selected at compile time by defining ZONE7X7_BACKEND as BitTrick (the default), Lookup, or BMI2,
+ * e.g., g++ -DZONE7X7_BACKEND=Lookup ..., then the primitives of Zone7x7Bitboard are routed to it (see dispatch()),
+ * except when they are evaluated at compile time, and except for the lanes of Zone7x7Bitboard::normalize_batch()
+ * note that BMI2 should only be selected for CPUs with fast pext/pdep, a warning is issued when the target is Zen 1/2
+ * (e.g., -march=znver2), whose pext/pdep are microcoded, or lacks BMI2; and that there is no runtime selection, since an indirect call per primitive costs more than any backend saves
+ */
+struct Zone7x7BitboardBackends {
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+
+	/**
+	 * the primitives of a backend, see Zone7x7Bitboard::transpose(), flip(), mirror(), and slide()
+	 */
+	struct Backend {
+		const char* name;
+		u64 (*transpose)(u64 x);
+		u64 (*flip)(u64 x);
+		u64 (*mirror)(u64 x);
+		u32 (*slide_offset)(u64 zone);
+	};
+
+	struct BitTrick {
+		static inline u64 transpose(u64 x) { return Zone7x7Bitboard::bittrick_transpose(x); }
+		static inline u64 flip(u64 x) { return Zone7x7Bitboard::bittrick_flip(x); }
+		static inline u64 mirror(u64 x) { return Zone7x7Bitboard::bittrick_mirror(x); }
+		static inline u32 slide_offset(u64 zone) { return Zone7x7Bitboard::bittrick_slide_offset(zone); }
+		static constexpr Backend backend() { return { "BitTrick", transpose, flip, mirror, slide_offset }; }
+	};
+
+	struct Lookup {
+		struct Tables {
+			u64 column[128]; // the 7 bits of a row spread into column A, i.e., bit i to bit (i * 7)
+			u32 reverse[128]; // the 7 bits of a row in reverse order
+			u32 skip[128];    // the shift of slide() for 7 bits of occupancy, i.e., max(ctz, 1) - 1
+		};
+		static inline constexpr Tables generate() {
+			Tables t = {};
+			for (u32 r = 0; r < 128; r++) {
+				for (u32 i = 0; i < 7; i++) {
+					if (!(r & (1u << i))) continue;
+					t.column[r] |= 1ull << (i * 7);
+					t.reverse[r] |= 1u << (6 - i);
+				}
+				u32 ctz = 0;
+				while (ctz < 7 && !(r & (1u << ctz))) ctz++;
+				t.skip[r] = (ctz ?: 1) - 1;
+			}
+			return t;
+		}
+		template<typename = void> struct Static { static constexpr Tables tables = generate(); };
+
+		static inline u64 transpose(u64 x) {
+			const Tables& t = Static<>::tables;
+			u64 z = 0;
+			for (u32 y = 0; y < 7; y++) z |= t.column[(x >> (y * 7)) & 127] << y;
+			return z;
+		}
+		static inline u64 flip(u64 x) {
+			u64 z = 0;
+			for (u32 y = 0; y < 7; y++) z |= ((x >> (y * 7)) & 127) << ((6 - y) * 7);
+			return z;
+		}
+		static inline u64 mirror(u64 x) {
+			const Tables& t = Static<>::tables;
+			u64 z = 0;
+			for (u32 y = 0; y < 7; y++) z |= u64(t.reverse[(x >> (y * 7)) & 127]) << (y * 7);
+			return z;
+		}
+		static inline u32 slide_offset(u64 zone) {
+			const Tables& t = Static<>::tables;
+			u32 rows = 0, cols = 0;
+			for (u32 y = 0; y < 7; y++) {
+				u32 row = (zone >> (y * 7)) & 127;
+				rows |= (row ? 1u : 0u) << y;
+				cols |= row;
+			}
+			u32 offset = 0;
+			if (!(rows & 64)) offset += t.skip[rows] * 7;
+			if (!(cols & 64)) offset += t.skip[cols];
+			return offset;
+		}
+		static constexpr Backend backend() { return { "Lookup", transpose, flip, mirror, slide_offset }; }
+	};
+
+#if defined(__x86_64__) || defined(__i386__)
+	struct BMI2 {
+		__attribute__((target("bmi,bmi2")))
+		static u64 transpose(u64 x) {
+			u64 z = 0;
+			for (u32 i = 0; i < 7; i++) z |= _pdep_u64(_pext_u64(x, Zone7x7Bitboard::COL_MASK(i)), Zone7x7Bitboard::ROW_MASK(i));
+			return z;
+		}
+		__attribute__((target("bmi,bmi2")))
+		static u64 flip(u64 x) {
+			u64 z = 0;
+			for (u32 i = 0; i < 7; i++) z |= _pdep_u64(_pext_u64(x, Zone7x7Bitboard::ROW_MASK(i)), Zone7x7Bitboard::ROW_MASK(6 - i));
+			return z;
+		}
+		__attribute__((target("bmi,bmi2")))
+		static u64 mirror(u64 x) {
+			u64 z = 0;
+			for (u32 i = 0; i < 7; i++) z |= _pdep_u64(_pext_u64(x, Zone7x7Bitboard::COL_MASK(i)), Zone7x7Bitboard::COL_MASK(6 - i));
+			return z;
+		}
+		__attribute__((target("bmi,bmi2")))
+		static u32 slide_offset(u64 zone) {
+			u32 offset = 0;
+			if (!(zone & Zone7x7Bitboard::ROW_MASK(6))) {
+				offset += ((_tzcnt_u64(zone | (1ull << 49)) / 7 ?: 1) - 1) * 7;
+			}
+			if (!(zone & Zone7x7Bitboard::COL_MASK(6))) {
+				u64 cols = 0;
+				for (u32 i = 0; i < 7; i++) cols |= _pext_u64(zone, Zone7x7Bitboard::ROW_MASK(i));
+				offset += (u32(_tzcnt_u64(cols | 0b10000000)) ?: 1) - 1;
+			}
+			return offset;
+		}
+		static constexpr Backend backend() { return { "BMI2", transpose, flip, mirror, slide_offset }; }
+	};
+#endif
+
+	/**
+	 * list all backends available on this CPU, BitTrick is always the first one
+	 * @return
+	 *  the end of the list
+	 */
+	static inline const Backend* available(Backend* list) {
+		*(list++) = BitTrick::backend();
+		*(list++) = Lookup::backend();
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("bmi2")) *(list++) = BMI2::backend();
+#endif
+		return list;
+	}
+
+	/**
+	 * @return the backend selected at compile time, see the description of Zone7x7BitboardBackends
+	 */
+	static inline constexpr Backend dispatch() {
+#if defined(ZONE7X7_BACKEND)
+		return ZONE7X7_BACKEND::backend();
+#else
+		return BitTrick::backend();
+#endif
+	}
+
+	/**
+	 * verify that all available backends agree with BitTrick (and Isomorphisms) over random boards
+	 * @param
+	 *  n    the number of random boards
+	 *  seed the random seed
+	 *  log  the stream to report mismatches
+	 * @return
+	 *  the number of mismatches
+	 */
+	static inline size_t verify(size_t n, u64 seed, std::ostream& log) {
+		Backend list[3];
+		const Backend* end = available(list);
+		std::mt19937_64 rng(seed);
+		size_t errors = 0;
+		for (size_t k = 0; k < n; k++) {
+			// mix dense, sparse, and small boards, with and without touching the borders
+			u64 x = rng() & Zone7x7Bitboard::BOARD_MASK;
+			if (k & 1) x &= rng();
+			if (k & 2) x &= rng() & rng();
+			if (k & 4) x &= (0x3f3f3full << (rng() % 22)) & Zone7x7Bitboard::BOARD_MASK;
+			if (k % 101 == 0) x = k % 2 ? Zone7x7Bitboard::BOARD_MASK : 0;
+
+			Zone7x7Bitboard::Isomorphisms iso(x);
+			for (u32 i = 0; i < 8; i++) {
+				if (Zone7x7Bitboard::Isomorphisms::transform(x, i) == iso[i]) continue;
+				if (errors++ < 16) log << "Isomorphisms::transform(" << x << ", " << i << ") mismatched" << std::endl;
+			}
+			for (const Backend* b = list + 1; b != end; b++) {
+				const char* failed = (b->transpose(x) != list->transpose(x)) ? "transpose"
+				                   : (b->flip(x) != list->flip(x)) ? "flip"
+				                   : (b->mirror(x) != list->mirror(x)) ? "mirror"
+				                   : (b->slide_offset(x) != list->slide_offset(x)) ? "slide_offset" : nullptr;
+				if (!failed) continue;
+				if (errors++ < 16) log << b->name << "::" << failed << "(" << x << ") mismatched" << std::endl;
+			}
+		}
+		return errors;
+	}
+};
+
+template<typename T>
+constexpr Zone7x7BitboardBackends::Lookup::Tables Zone7x7BitboardBackends::Lookup::Static<T>::tables;
+
+#if defined(ZONE7X7_ROUTED)
+inline Zone7x7Bitboard::u32 Zone7x7Bitboard::backend_slide_offset(u64 zone) { return Zone7x7BitboardBackends::ZONE7X7_BACKEND::slide_offset(zone); }
+inline Zone7x7Bitboard::u64 Zone7x7Bitboard::backend_transpose(u64 x) { return Zone7x7BitboardBackends::ZONE7X7_BACKEND::transpose(x); }
+inline Zone7x7Bitboard::u64 Zone7x7Bitboard::backend_flip(u64 x) { return Zone7x7BitboardBackends::ZONE7X7_BACKEND::flip(x); }
+inline Zone7x7Bitboard::u64 Zone7x7Bitboard::backend_mirror(u64 x) { return Zone7x7BitboardBackends::ZONE7X7_BACKEND::mirror(x); }
+#endif
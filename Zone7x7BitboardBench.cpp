@@ -0,0 +1,344 @@
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardIO.h"
+#include "Zone7x7BitboardBackends.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <functional>
+#include <pthread.h>
+#include <sched.h>
+
+using u64 = Zone7x7Bitboard::u64;
+using u32 = Zone7x7Bitboard::u32;
+using namespace Zone7x7BitboardIO;
+
+static const char* usage =
+	"Usage: bitboard-bench [OPTION]...\n"
+	"Measure the primitives of Zone7x7Bitboard on random boards and on pattern corpora.\n"
+	"The random boards are of two datasets: random, whose zones almost always touch all borders,\n"
+	"and sparse, whose zones are within random rectangles so that slide() moves them.\n"
+	"\n"
+	"  -n, --boards N      number of boards of each random dataset, default is 1048576\n"
+	"  -c, --corpus DIR    add the text files under DIR as a dataset, default is examples/*\n"
+	"  -r, --reps N        number of timed repetitions, default is 10\n"
+	"  -w, --warmup N      number of untimed repetitions, default is 2\n"
+	"  -j, --threads N     run each benchmark on N threads concurrently, default is 1\n"
+	"  -p, --cpu N         pin the threads to CPUs starting from N, default is not pinned\n"
+	"  -f, --filter TEXT   only run the benchmarks whose names contain TEXT\n"
+	"      --csv           output CSV\n"
+	"      --json          output JSON\n"
+	"  -h, --help          display this help and exit\n";
+
+struct Options {
+	size_t boards = 1 << 20;
+	std::vector<std::string> corpora;
+	u32 reps = 10;
+	u32 warmup = 2;
+	u32 threads = 1;
+	int cpu = -1;
+	std::string filter;
+	std::string format = "text";
+};
+
+struct Dataset {
+	std::string name;
+	std::vector<Zone7x7Bitboard> boards;
+};
+
+struct Result {
+	std::string bench;
+	std::string dataset;
+	size_t boards;
+	u32 threads;
+	double ns_min, ns_median, ns_mean; // nanoseconds per board per thread
+	double boards_per_sec;             // of all threads, based on the median
+};
+
+/**
+ * prevent the compiler from optimizing away a value
+ */
+template<typename T>
+static inline void keep(const T& x) { asm volatile("" : : "g"(&x) : "memory"); }
+
+/**
+ * a streambuf that discards everything, for measuring operator<<
+ */
+struct NullBuffer : std::streambuf {
+	char buf[256];
+	NullBuffer() { setp(buf, buf + sizeof(buf)); }
+	int overflow(int c) override { setp(buf, buf + sizeof(buf)); return c; }
+};
+
+static void pin(int cpu) {
+	if (cpu < 0) return;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % CPU_SETSIZE, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/**
+ * run func(boards) on all threads simultaneously for warmup + reps times
+ * each thread runs on a private copy of the boards, which is restored before each round (untimed),
+ * so that in-place benchmarks (e.g., normalize) never run on boards they have already processed
+ * @return
+ *  the statistics of the timed repetitions
+ */
+template<typename Func>
+static Result measure(const std::string& bench, const Dataset& data, const Options& opts, Func func) {
+	const u32 rounds = opts.warmup + opts.reps;
+	const size_t inner = std::max<size_t>(1, (1 << 16) / std::max<size_t>(data.boards.size(), 1)); // for small datasets
+	std::vector<double> elapsed(rounds);
+	std::atomic<u32> ready(0), done(0);
+	std::atomic<int> round(-1);
+
+	auto work = [&](u32 id) {
+		pin(opts.cpu < 0 ? -1 : opts.cpu + int(id));
+		std::vector<Zone7x7Bitboard> source, boards; // the dataset repeated inner times, and its private copy
+		for (size_t i = 0; i < inner; i++) source.insert(source.end(), data.boards.begin(), data.boards.end());
+		for (u32 r = 0; r < rounds; r++) {
+			boards = source;
+			ready.fetch_add(1);
+			while (round.load() < int(r)) std::this_thread::yield();
+			func(boards);
+			done.fetch_add(1);
+		}
+	};
+	std::vector<std::thread> workers;
+	for (u32 t = 0; t < opts.threads; t++) workers.emplace_back(work, t);
+	for (u32 r = 0; r < rounds; r++) {
+		while (ready.load() < (r + 1) * opts.threads) std::this_thread::yield();
+		auto start = std::chrono::steady_clock::now();
+		round.store(r);
+		while (done.load() < (r + 1) * opts.threads) std::this_thread::yield();
+		elapsed[r] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	}
+	for (std::thread& worker : workers) worker.join();
+
+	std::vector<double> timed(elapsed.begin() + opts.warmup, elapsed.end());
+	std::sort(timed.begin(), timed.end());
+	const double n = std::max<size_t>(data.boards.size(), 1) * inner;
+	Result res;
+	res.bench = bench;
+	res.dataset = data.name;
+	res.boards = data.boards.size();
+	res.threads = opts.threads;
+	res.ns_min = timed.front() / n;
+	res.ns_median = timed[timed.size() / 2] / n;
+	double sum = 0;
+	for (double t : timed) sum += t;
+	res.ns_mean = sum / timed.size() / n;
+	res.boards_per_sec = 1e9 / res.ns_median * opts.threads;
+	return res;
+}
+
+/**
+ * define a benchmark that applies expr to each board (named z), and keeps the result
+ */
+#define BENCH_EACH(name, expr) { name, [](std::vector<Zone7x7Bitboard>& boards) { \
+	for (Zone7x7Bitboard& z : boards) { auto x = (expr); keep(x); } } }
+
+struct Bench {
+	std::string name;
+	std::function<void(std::vector<Zone7x7Bitboard>& boards)> func;
+};
+
+static std::vector<Bench> benchmarks() {
+	return {
+		BENCH_EACH("transpose", (z.transpose(), z.zone)),
+		BENCH_EACH("flip", (z.flip(), z.zone)),
+		BENCH_EACH("mirror", (z.mirror(), z.zone)),
+		BENCH_EACH("Isomorphisms", Zone7x7Bitboard::Isomorphisms(z.zone)),
+		BENCH_EACH("transform(i)", (z.transform(z.zone % 8), z.zone)),
+		BENCH_EACH("slide", (z.slide(), z.zone)),
+		BENCH_EACH("normalize(false)", (z.normalize(false), z.zone)),
+		BENCH_EACH("normalize(true)", (z.normalize(true), z.zone)),
+		{ "normalize_batch(false)", [](std::vector<Zone7x7Bitboard>& boards) {
+			Zone7x7Bitboard::normalize_batch(boards.data(), boards.size(), false);
+		} },
+		{ "normalize_batch(true)", [](std::vector<Zone7x7Bitboard>& boards) {
+			Zone7x7Bitboard::normalize_batch(boards.data(), boards.size(), true);
+		} },
+		{ "operator<", [](std::vector<Zone7x7Bitboard>& boards) {
+			u64 less = 0;
+			for (size_t i = 1; i < boards.size(); i++) less += boards[i - 1] < boards[i];
+			keep(less);
+		} },
+		{ "operator==", [](std::vector<Zone7x7Bitboard>& boards) {
+			u64 same = 0;
+			for (size_t i = 1; i < boards.size(); i++) same += boards[i - 1] == boards[i];
+			keep(same);
+		} },
+		BENCH_EACH("hash", z.hash()),
+		{ "operator<<", [](std::vector<Zone7x7Bitboard>& boards) {
+			NullBuffer buf;
+			std::ostream out(&buf);
+			for (const Zone7x7Bitboard& z : boards) out << z;
+		} },
+	};
+}
+
+static std::vector<Bench> backend_benchmarks() {
+	using Backend = Zone7x7BitboardBackends::Backend;
+	Backend backends[3];
+	const Backend* end = Zone7x7BitboardBackends::available(backends);
+	std::vector<Bench> list;
+	for (const Backend* it = backends; it != end; it++) {
+		const Backend b = *it;
+		const std::string prefix = std::string(b.name) + "::";
+		list.push_back({ prefix + "transpose", [b](std::vector<Zone7x7Bitboard>& boards) {
+			for (Zone7x7Bitboard& z : boards) { u64 x = b.transpose(z.zone); keep(x); }
+		} });
+		list.push_back({ prefix + "flip", [b](std::vector<Zone7x7Bitboard>& boards) {
+			for (Zone7x7Bitboard& z : boards) { u64 x = b.flip(z.zone); keep(x); }
+		} });
+		list.push_back({ prefix + "mirror", [b](std::vector<Zone7x7Bitboard>& boards) {
+			for (Zone7x7Bitboard& z : boards) { u64 x = b.mirror(z.zone); keep(x); }
+		} });
+		list.push_back({ prefix + "slide_offset", [b](std::vector<Zone7x7Bitboard>& boards) {
+			for (Zone7x7Bitboard& z : boards) { u32 x = b.slide_offset(z.zone); keep(x); }
+		} });
+	}
+	return list;
+}
+
+static Dataset random_boards(size_t n) {
+	Dataset data{ "random", {} };
+	std::mt19937_64 rng(0);
+	data.boards.reserve(n);
+	for (size_t i = 0; i < n; i++) {
+		u64 zone = rng() & Zone7x7Bitboard::BOARD_MASK;
+		u64 black = rng() & zone;
+		data.boards.emplace_back(zone, black, rng() & zone & ~black);
+	}
+	return data;
+}
+
+/**
+ * random boards whose zones are within random rectangles of 2x2 to 5x5, which are placed anywhere
+ */
+static Dataset sparse_boards(size_t n) {
+	Dataset data{ "sparse", {} };
+	std::mt19937_64 rng(1);
+	data.boards.reserve(n);
+	for (size_t i = 0; i < n; i++) {
+		const u32 w = 2 + rng() % 4, h = 2 + rng() % 4, x = rng() % (8 - w), y = rng() % (8 - h);
+		u64 rect = 0;
+		for (u32 r = 0; r < h; r++) rect |= ((1ull << w) - 1) << ((y + r) * 7 + x);
+		u64 zone = rect & (rng() | rng());
+		u64 black = rng() & zone;
+		data.boards.emplace_back(zone, black, rng() & zone & ~black);
+	}
+	return data;
+}
+
+static bool load_corpus(const std::string& dir, Dataset& data) {
+	std::string name = dir;
+	while (name.size() > 1 && name.back() == '/') name.pop_back();
+	data.name = name.substr(name.find_last_of('/') + 1);
+	for (const std::string& path : list_directory(dir, false)) {
+		MappedFile file(path);
+		if (!file.good()) {
+			std::cerr << "bitboard-bench: " << file.error() << std::endl;
+			return false;
+		}
+		size_t line = 1;
+		for (const char* p = file.begin(); p != file.end(); line++) {
+			Zone7x7Bitboard z;
+			int n = parse_board(p, file.end(), z);
+			if (n < 0) {
+				std::cerr << "bitboard-bench: " << path << ":" << line << ": invalid board" << std::endl;
+				return false;
+			}
+			if (n > 0) data.boards.push_back(z);
+		}
+	}
+	return true;
+}
+
+static void print(const std::vector<Result>& results, const Options& opts) {
+	std::cout << std::fixed << std::setprecision(2);
+	if (opts.format == "csv") {
+		std::cout << "bench,dataset,boards,threads,ns_min,ns_median,ns_mean,boards_per_sec" << std::endl;
+		for (const Result& r : results) {
+			std::cout << r.bench << ',' << r.dataset << ',' << r.boards << ',' << r.threads << ',';
+			std::cout << r.ns_min << ',' << r.ns_median << ',' << r.ns_mean << ',' << r.boards_per_sec << std::endl;
+		}
+	} else if (opts.format == "json") {
+		std::cout << "[" << std::endl;
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			std::cout << "  {\"bench\": \"" << r.bench << "\", \"dataset\": \"" << r.dataset << "\", ";
+			std::cout << "\"boards\": " << r.boards << ", \"threads\": " << r.threads << ", ";
+			std::cout << "\"ns_min\": " << r.ns_min << ", \"ns_median\": " << r.ns_median << ", ";
+			std::cout << "\"ns_mean\": " << r.ns_mean << ", \"boards_per_sec\": " << r.boards_per_sec << "}";
+			std::cout << (i + 1 < results.size() ? "," : "") << std::endl;
+		}
+		std::cout << "]" << std::endl;
+	} else {
+		std::cout << std::left << std::setw(26) << "bench" << std::setw(10) << "dataset" << std::right;
+		std::cout << std::setw(10) << "boards" << std::setw(12) << "ns/op" << std::setw(12) << "ns/op(min)";
+		std::cout << std::setw(16) << "boards/sec" << std::endl;
+		for (const Result& r : results) {
+			std::cout << std::left << std::setw(26) << r.bench << std::setw(10) << r.dataset << std::right;
+			std::cout << std::setw(10) << r.boards << std::setw(12) << r.ns_median << std::setw(12) << r.ns_min;
+			std::cout << std::setw(16) << std::setprecision(0) << r.boards_per_sec << std::setprecision(2) << std::endl;
+		}
+	}
+}
+
+int main(int argc, const char* argv[]) {
+	Options opts;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool value = i + 1 < argc;
+		if ((arg == "-n" || arg == "--boards") && value) {
+			opts.boards = std::strtoull(argv[++i], nullptr, 0);
+		} else if ((arg == "-c" || arg == "--corpus") && value) {
+			opts.corpora.push_back(argv[++i]);
+		} else if ((arg == "-r" || arg == "--reps") && value) {
+			opts.reps = std::max(1, std::atoi(argv[++i]));
+		} else if ((arg == "-w" || arg == "--warmup") && value) {
+			opts.warmup = std::max(0, std::atoi(argv[++i]));
+		} else if ((arg == "-j" || arg == "--threads") && value) {
+			opts.threads = std::max(1, std::atoi(argv[++i]));
+		} else if ((arg == "-p" || arg == "--cpu") && value) {
+			opts.cpu = std::atoi(argv[++i]);
+		} else if ((arg == "-f" || arg == "--filter") && value) {
+			opts.filter = argv[++i];
+		} else if (arg == "--csv" || arg == "--json") {
+			opts.format = arg.substr(2);
+		} else if (arg == "-h" || arg == "--help") {
+			std::cout << usage;
+			return 0;
+		} else {
+			std::cerr << "bitboard-bench: invalid option '" << arg << "'" << std::endl << usage;
+			return 1;
+		}
+	}
+	if (opts.corpora.empty()) opts.corpora = list_directory("examples", true);
+
+	std::vector<Dataset> datasets = { random_boards(opts.boards), sparse_boards(opts.boards) };
+	for (const std::string& dir : opts.corpora) {
+		Dataset data;
+		if (!load_corpus(dir, data)) return 1;
+		if (data.boards.size()) datasets.push_back(std::move(data));
+	}
+
+	std::vector<Bench> list = benchmarks();
+	for (const Bench& b : backend_benchmarks()) list.push_back(b);
+
+	std::vector<Result> results;
+	for (const Dataset& data : datasets) {
+		for (const Bench& b : list) {
+			if (b.name.find(opts.filter) == std::string::npos) continue;
+			results.push_back(measure(b.name, data, opts, b.func));
+		}
+	}
+	print(results, opts);
+	return 0;
+}
@@ -0,0 +1,308 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardArray.h"
+#include "Zone7x7BitboardIO.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * a compact binary database of normalized boards, grouped into named sections (e.g., corner, side)
+ *
+ * the file is used directly through a memory mapping, and a lookup is two binary searches without any parsing
+ *
+ *  +-----------+---------------------+------------------------------+---------------------------+
+ *  | Header    | Section x sections  | Directory x (total zones)    | Records (packed keys)     |
+ *  +-----------+---------------------+------------------------------+---------------------------+
+ *
+ * each section owns a directory of distinct zones sorted in ascending order,
+ * and each directory entry owns a run of fixed-width records of the boards with that zone.
+ * a record packs the stones in the zone, i.e., (pext(black, zone) << k) | pext(white, zone),
+ * where k is the number of locations in the zone, so a record takes only ceil(2k / 8) bytes.
+ * records are stored in big-endian order so that memcmp() of records agrees with operator<().
+ *
+ * all integers are little-endian, and all boards are normalized with normalize(slide) of the header flag
+ * note that stones outside the zone cannot be stored, so such boards are rejected by Builder::add()
+ */
+class Zone7x7BitboardDatabase {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+
+	static inline constexpr const char* MAGIC() { return "Z7X7PDB"; } // 8 bytes including the terminator
+	static constexpr u32 VERSION = 1;
+	static constexpr u32 FLAG_SLIDE = 1u << 0;
+
+	struct Header {
+		char magic[8];
+		u32 version;
+		u32 flags;
+		u32 sections; // number of sections
+		u32 reserved;
+		u64 records;  // number of records in all sections
+		u64 size;     // size of the whole file in bytes
+		u64 padding[3];
+	};
+	struct Section {
+		char name[32];
+		u64 directory; // file offset of the first directory entry
+		u64 zones;     // number of directory entries
+		u64 records;   // number of records in this section
+		u64 reserved;
+	};
+	struct Directory {
+		u64 zone;
+		u64 offset; // file offset of the first record
+		u32 count;  // number of records
+		u32 width;  // size of each record in bytes
+	};
+	static_assert(sizeof(Header) == 64 && sizeof(Section) == 64 && sizeof(Directory) == 24, "unexpected padding");
+
+	/**
+	 * the size of a record in bytes for the given zone
+	 */
+	static inline constexpr u32 record_width(u64 zone) { return (__builtin_popcountll(zone) * 2 + 7) / 8; }
+	/**
+	 * pack the stones of a board into a big-endian record
+	 */
+	static inline void pack(char* out, const Zone7x7Bitboard& z) {
+		const u32 k = __builtin_popcountll(z.zone), width = record_width(z.zone);
+		unsigned __int128 key = (unsigned __int128)(Zone7x7Bitboard::pext(z.black, z.zone)) << k;
+		key |= Zone7x7Bitboard::pext(z.white, z.zone);
+		for (u32 i = 0; i < width; i++) out[i] = char(key >> ((width - 1 - i) * 8));
+	}
+	/**
+	 * unpack a record of the given zone
+	 */
+	static inline Zone7x7Bitboard unpack(const char* in, u64 zone) {
+		const u32 k = __builtin_popcountll(zone), width = record_width(zone);
+		unsigned __int128 key = 0;
+		for (u32 i = 0; i < width; i++) key = (key << 8) | static_cast<unsigned char>(in[i]);
+		u64 black = Zone7x7Bitboard::pdep(u64(key >> k), zone);
+		u64 white = Zone7x7Bitboard::pdep(u64(key) & ((1ull << k) - 1), zone);
+		return { zone, black, white };
+	}
+
+public:
+	/**
+	 * open a database file, check good() or error() for the result
+	 * all sections and directory entries are validated against the file size, see validate()
+	 */
+	inline Zone7x7BitboardDatabase(const std::string& path) : file(path), header(nullptr) {
+		if (!file.good()) {
+			err = file.error();
+			return;
+		}
+		if (file.size() < sizeof(Header)) {
+			err = path + ": file too small";
+			return;
+		}
+		header = reinterpret_cast<const Header*>(file.data());
+		if (std::memcmp(header->magic, MAGIC(), sizeof(header->magic)) != 0 || header->version != VERSION) {
+			err = path + ": not a database of version " + std::to_string(VERSION);
+		} else if (header->size != file.size() || sizeof(Header) + header->sections * sizeof(Section) > file.size()) {
+			err = path + ": truncated database";
+		} else if (!validate()) {
+			err = path + ": corrupt section or directory";
+		}
+		if (!err.empty()) header = nullptr;
+	}
+
+	inline bool good() const { return err.empty(); }
+	inline const std::string& error() const { return err; }
+	inline bool slide() const { return header->flags & FLAG_SLIDE; }
+	inline u64 records() const { return header->records; }
+	inline u32 sections() const { return header->sections; }
+	inline const Section& section(u32 i) const {
+		return reinterpret_cast<const Section*>(file.data() + sizeof(Header))[i];
+	}
+	/**
+	 * find the section with the given name
+	 * @return
+	 *  the section index, or sections() if not found
+	 */
+	inline u32 find_section(const std::string& name) const {
+		u32 i = 0;
+		while (i < sections() && name != section(i).name) i++;
+		return i;
+	}
+
+	/**
+	 * look up a board in the given section
+	 * @param
+	 *  z       the board, which is normalized before lookup
+	 *  section the section index
+	 * @return
+	 *  whether the board (or any of its isomorphisms) is in the section
+	 */
+	inline bool contains(Zone7x7Bitboard z, u32 section) const {
+		z.normalize(slide());
+		return contains_normalized(z, section);
+	}
+	/**
+	 * look up a board in all sections
+	 * @return
+	 *  the index of the first section that contains the board, or sections() if not found
+	 */
+	inline u32 find(Zone7x7Bitboard z) const {
+		z.normalize(slide());
+		u32 i = 0;
+		while (i < sections() && !contains_normalized(z, i)) i++;
+		return i;
+	}
+
+	/**
+	 * invoke func(board) for all boards of the given section in ascending order
+	 */
+	template<typename Func>
+	inline void for_each(u32 section, Func func) const {
+		const Section& s = this->section(section);
+		const Directory* dir = reinterpret_cast<const Directory*>(file.data() + s.directory);
+		for (const Directory* d = dir; d != dir + s.zones; d++) {
+			const char* rec = file.data() + d->offset;
+			for (u32 i = 0; i < d->count; i++, rec += d->width) func(unpack(rec, d->zone));
+		}
+	}
+
+protected:
+	/**
+	 * check that each section has a terminated name and a directory inside the file,
+	 * and that each directory entry has ascending zones and a run of records inside the file, whose width fits the zone
+	 * @return
+	 *  whether all sections and directory entries are valid
+	 */
+	inline bool validate() const {
+		const u64 size = file.size();
+		for (u32 i = 0; i < sections(); i++) {
+			const Section& s = section(i);
+			if (!std::memchr(s.name, 0, sizeof(s.name))) return false;
+			if (s.directory > size || s.zones > (size - s.directory) / sizeof(Directory)) return false;
+			const Directory* dir = reinterpret_cast<const Directory*>(file.data() + s.directory);
+			for (const Directory* d = dir; d != dir + s.zones; d++) {
+				if (d != dir && d->zone <= (d - 1)->zone) return false;
+				if ((d->zone & ~Zone7x7Bitboard::BOARD_MASK) || d->width != record_width(d->zone)) return false;
+				if (d->offset > size || u64(d->count) * d->width > size - d->offset) return false;
+			}
+		}
+		return true;
+	}
+
+	inline bool contains_normalized(const Zone7x7Bitboard& z, u32 section) const {
+		const Section& s = this->section(section);
+		const Directory* dir = reinterpret_cast<const Directory*>(file.data() + s.directory);
+		const Directory* d = std::lower_bound(dir, dir + s.zones, z.zone,
+			[](const Directory& d, u64 zone) { return d.zone < zone; });
+		if (d == dir + s.zones || d->zone != z.zone || ((z.black | z.white) & ~z.zone)) return false;
+
+		char key[16];
+		pack(key, z);
+		const char* rec = file.data() + d->offset;
+		for (u32 lo = 0, hi = d->count; lo < hi; ) {
+			u32 mid = (lo + hi) / 2;
+			int cmp = std::memcmp(rec + mid * d->width, key, d->width);
+			if (cmp == 0) return true;
+			if (cmp < 0) lo = mid + 1;
+			else hi = mid;
+		}
+		return false;
+	}
+
+protected:
+	Zone7x7BitboardIO::MappedFile file;
+	const Header* header;
+	std::string err;
+
+public:
+	/**
+	 * build a database from boards, e.g.,
+	 *   Zone7x7BitboardDatabase::Builder builder(false);
+	 *   builder.add("corner", board);
+	 *   builder.write("examples.db");
+	 */
+	class Builder {
+	public:
+		/**
+		 * @param
+		 *  allow_slide set as true to normalize boards with slide(), see Zone7x7Bitboard::normalize()
+		 */
+		inline Builder(bool allow_slide = false) : allow_slide(allow_slide) {}
+		/**
+		 * add a board to the given section, sections are written in the order of their first boards
+		 * @return
+		 *  whether the board is added, i.e., it has no stones outside its zone and no locations outside the board,
+		 *  otherwise its record could not restore it exactly
+		 */
+		inline bool add(const std::string& section, const Zone7x7Bitboard& z) {
+			if (((z.black | z.white) & ~z.zone) || (z.zone & ~Zone7x7Bitboard::BOARD_MASK)) return false;
+			auto it = index.find(section);
+			if (it == index.end()) {
+				it = index.emplace(section, names.size()).first;
+				names.push_back(section);
+				boards.emplace_back();
+			}
+			boards[it->second].push_back(z);
+			return true;
+		}
+		/**
+		 * normalize, sort, deduplicate, and write all boards to the given file
+		 * @return
+		 *  whether the file is successfully written
+		 */
+		inline bool write(const std::string& path) {
+			Header header = {};
+			std::memcpy(header.magic, MAGIC(), sizeof(header.magic));
+			header.version = VERSION;
+			header.flags = allow_slide ? FLAG_SLIDE : 0;
+			header.sections = names.size();
+
+			std::vector<Section> sections(names.size());
+			std::vector<Directory> directory;
+			std::vector<char> data;
+			for (size_t i = 0; i < names.size(); i++) {
+				Zone7x7BitboardArray& list = boards[i];
+				list.normalize(allow_slide);
+				list.dedup();
+
+				Section& s = sections[i];
+				std::strncpy(s.name, names[i].c_str(), sizeof(s.name) - 1);
+				s.directory = directory.size(); // relocated below
+				s.records = list.size();
+				for (size_t k = 0; k < list.size(); k++) {
+					if (k == 0 || list.zone[k] != list.zone[k - 1]) {
+						directory.push_back({ list.zone[k], data.size(), 0, record_width(list.zone[k]) });
+					}
+					directory.back().count++;
+					data.resize(data.size() + directory.back().width);
+					pack(data.data() + data.size() - directory.back().width, list[k]);
+				}
+				s.zones = directory.size() - s.directory;
+				header.records += s.records;
+			}
+
+			const u64 base = sizeof(Header) + sections.size() * sizeof(Section);
+			for (Section& s : sections) s.directory = base + s.directory * sizeof(Directory);
+			for (Directory& d : directory) d.offset += base + directory.size() * sizeof(Directory);
+			header.size = base + directory.size() * sizeof(Directory) + data.size();
+
+			FILE* out = std::fopen(path.c_str(), "wb");
+			if (!out) return false;
+			std::fwrite(&header, sizeof(Header), 1, out);
+			std::fwrite(sections.data(), sizeof(Section), sections.size(), out);
+			std::fwrite(directory.data(), sizeof(Directory), directory.size(), out);
+			std::fwrite(data.data(), 1, data.size(), out);
+			bool ok = !std::ferror(out);
+			return (std::fclose(out) == 0) && ok;
+		}
+
+	protected:
+		bool allow_slide;
+		std::map<std::string, size_t> index;
+		std::vector<std::string> names;
+		std::vector<Zone7x7BitboardArray> boards;
+	};
+};
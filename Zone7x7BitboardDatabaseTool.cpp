@@ -0,0 +1,149 @@
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardDatabase.h"
+#include "Zone7x7BitboardIO.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using u64 = Zone7x7Bitboard::u64;
+using u32 = Zone7x7Bitboard::u32;
+using namespace Zone7x7BitboardIO;
+
+static const char* usage =
+	"Usage: bitboard-db build [--slide] DATABASE DIR...\n"
+	"       bitboard-db find DATABASE [SECTION] < BOARDS\n"
+	"       bitboard-db dump DATABASE [SECTION]\n"
+	"       bitboard-db info DATABASE\n"
+	"\n"
+	"build  convert text corpora to DATABASE, each DIR is either a directory of text files (a section\n"
+	"       named after DIR), or a directory of such directories (e.g., examples/)\n"
+	"find   look up the boards (one \"zone black white\" per line) from the standard input,\n"
+	"       and print the section containing each board, or \"-\" if not found\n"
+	"dump   print the normalized boards of all sections, or of the given SECTION\n"
+	"info   print the sections of DATABASE\n";
+
+static std::string basename_of(std::string path) {
+	while (path.size() > 1 && path.back() == '/') path.pop_back();
+	return path.substr(path.find_last_of('/') + 1);
+}
+
+static bool load_section(Zone7x7BitboardDatabase::Builder& builder, const std::string& dir) {
+	const std::string section = basename_of(dir);
+	for (const std::string& path : list_directory(dir, false)) {
+		MappedFile file(path);
+		if (!file.good()) {
+			std::cerr << "bitboard-db: " << file.error() << std::endl;
+			return false;
+		}
+		size_t line = 1;
+		for (const char* p = file.begin(); p != file.end(); line++) {
+			Zone7x7Bitboard z;
+			int n = parse_board(p, file.end(), z);
+			if (n < 0) {
+				std::cerr << "bitboard-db: " << path << ":" << line << ": invalid board" << std::endl;
+				return false;
+			}
+			if (n > 0 && !builder.add(section, z)) {
+				std::cerr << "bitboard-db: " << path << ":" << line << ": stones outside the zone" << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static int build(std::vector<std::string> args) {
+	bool slide = false;
+	auto it = std::find(args.begin(), args.end(), "--slide");
+	if (it != args.end()) {
+		slide = true;
+		args.erase(it);
+	}
+	if (args.size() < 2) {
+		std::cerr << usage;
+		return 1;
+	}
+	Zone7x7BitboardDatabase::Builder builder(slide);
+	for (size_t i = 1; i < args.size(); i++) {
+		std::vector<std::string> sections = list_directory(args[i], true);
+		if (sections.empty()) sections.push_back(args[i]);
+		for (const std::string& dir : sections) {
+			if (!load_section(builder, dir)) return 1;
+		}
+	}
+	if (!builder.write(args[0])) {
+		std::cerr << "bitboard-db: " << args[0] << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+static u32 select_section(const Zone7x7BitboardDatabase& db, const std::vector<std::string>& args) {
+	if (args.size() < 2) return db.sections();
+	u32 i = db.find_section(args[1]);
+	if (i == db.sections()) std::cerr << "bitboard-db: no section named '" << args[1] << "'" << std::endl;
+	return i;
+}
+
+static int find(const Zone7x7BitboardDatabase& db, const std::vector<std::string>& args) {
+	u32 section = select_section(db, args);
+	if (args.size() >= 2 && section == db.sections()) return 1;
+	MappedFile input("-");
+	size_t line = 1;
+	for (const char* p = input.begin(); p != input.end(); line++) {
+		Zone7x7Bitboard z;
+		int n = parse_board(p, input.end(), z);
+		if (n < 0) {
+			std::cerr << "bitboard-db: -:" << line << ": invalid board" << std::endl;
+			return 1;
+		}
+		if (n == 0) continue;
+		u32 i = (args.size() < 2) ? db.find(z) : (db.contains(z, section) ? section : db.sections());
+		std::cout << (i < db.sections() ? db.section(i).name : "-") << '\n';
+	}
+	return 0;
+}
+
+static int dump(const Zone7x7BitboardDatabase& db, const std::vector<std::string>& args) {
+	u32 section = select_section(db, args);
+	if (args.size() >= 2 && section == db.sections()) return 1;
+	for (u32 i = 0; i < db.sections(); i++) {
+		if (section != db.sections() && section != i) continue;
+		db.for_each(i, [](const Zone7x7Bitboard& z) {
+			char line[64];
+			std::cout.write(line, format_board(line, z) - line);
+		});
+	}
+	return 0;
+}
+
+static int info(const Zone7x7BitboardDatabase& db) {
+	std::cout << "records: " << db.records() << ", slide: " << (db.slide() ? "true" : "false") << std::endl;
+	for (u32 i = 0; i < db.sections(); i++) {
+		const auto& s = db.section(i);
+		std::cout << s.name << ": " << s.records << " records, " << s.zones << " zones" << std::endl;
+	}
+	return 0;
+}
+
+int main(int argc, const char* argv[]) {
+	std::vector<std::string> args(argv + std::min(argc, 2), argv + argc);
+	std::string command = argc > 1 ? argv[1] : "";
+	if (command == "build") return build(args);
+	if ((command == "find" || command == "dump" || command == "info") && args.size() >= 1) {
+		Zone7x7BitboardDatabase db(args[0]);
+		if (!db.good()) {
+			std::cerr << "bitboard-db: " << db.error() << std::endl;
+			return 1;
+		}
+		if (command == "find") return find(db, args);
+		if (command == "dump") return dump(db, args);
+		return info(db);
+	}
+	if (command == "-h" || command == "--help") {
+		std::cout << usage;
+		return 0;
+	}
+	std::cerr << usage;
+	return 1;
+}
@@ -0,0 +1,129 @@
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardEnumerator.h"
+#include "Zone7x7BitboardIO.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+
+using u64 = Zone7x7Bitboard::u64;
+using u32 = Zone7x7Bitboard::u32;
+using namespace Zone7x7BitboardIO;
+
+static const char* usage =
+	"Usage: bitboard-enumerate [OPTION]... ZONE...\n"
+	"       bitboard-enumerate [OPTION]... -n N\n"
+	"Enumerate the distinct boards (one normalized board per class of isomorphic boards) of ZONEs,\n"
+	"or of all connected zones with at most N locations. A zone may have at most 40 locations.\n"
+	"Numbers can be decimal, octal (0...), hexadecimal (0x...), or binary (0b...).\n"
+	"\n"
+	"  -n, --cells N       enumerate all connected zones with 1 to N locations\n"
+	"  -s, --slide         invoke slide() for all isomorphisms, i.e., normalize(true)\n"
+	"  -v, --valid         only enumerate the boards whose blocks have liberties\n"
+	"  -c, --count         only print the number of boards\n"
+	"  -b, --binary        output binary records (zone, black, white as 64-bit little-endian)\n"
+	"  -o, --output FILE   write to FILE instead of the standard output\n"
+	"  -j, --threads N     use N threads, default is the number of CPUs\n"
+	"  -h, --help          display this help and exit\n"
+	"\n"
+	"The boards are written as they are found, so their order varies between runs.\n";
+
+struct Options {
+	std::vector<u64> zones;
+	u32 cells = 0;
+	bool slide = false;
+	bool valid = false;
+	bool count = false;
+	bool binary = false;
+	std::string output = "-";
+	u32 threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+int main(int argc, const char* argv[]) {
+	Options opts;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "-n" || arg == "--cells") && i + 1 < argc) {
+			opts.cells = std::max(0, std::atoi(argv[++i]));
+			if (opts.cells > Zone7x7BitboardEnumerator::MAX_CELLS) {
+				std::cerr << "bitboard-enumerate: too many cells '" << argv[i] << "'" << std::endl;
+				return 1;
+			}
+		} else if (arg == "-s" || arg == "--slide") {
+			opts.slide = true;
+		} else if (arg == "-v" || arg == "--valid") {
+			opts.valid = true;
+		} else if (arg == "-c" || arg == "--count") {
+			opts.count = true;
+		} else if (arg == "-b" || arg == "--binary") {
+			opts.binary = true;
+		} else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+			opts.output = argv[++i];
+		} else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+			opts.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "-h" || arg == "--help") {
+			std::cout << usage;
+			return 0;
+		} else if (arg.size() > 1 && arg[0] == '-') {
+			std::cerr << "bitboard-enumerate: invalid option '" << arg << "'" << std::endl << usage;
+			return 1;
+		} else {
+			const char* p = arg.c_str();
+			u64 zone;
+			if (!parse_number(p, p + arg.size(), zone) || *p || (zone & ~Zone7x7Bitboard::BOARD_MASK)) {
+				std::cerr << "bitboard-enumerate: invalid zone '" << arg << "'" << std::endl;
+				return 1;
+			}
+			if (u32(__builtin_popcountll(zone)) > Zone7x7BitboardEnumerator::MAX_CELLS) {
+				std::cerr << "bitboard-enumerate: too many locations in zone '" << arg << "'" << std::endl;
+				return 1;
+			}
+			opts.zones.push_back(zone);
+		}
+	}
+	Zone7x7BitboardEnumerator enumerator(opts.slide, opts.valid);
+	if (opts.cells) {
+		std::vector<u64> zones = enumerator.zones(opts.cells);
+		opts.zones.insert(opts.zones.end(), zones.begin(), zones.end());
+	}
+	if (opts.zones.empty()) {
+		std::cerr << usage;
+		return 1;
+	}
+	// the same zone would be enumerated twice if it were given twice, e.g., both as ZONE and by -n
+	for (u64& zone : opts.zones) zone = enumerator.canonical_zone(zone);
+	std::sort(opts.zones.begin(), opts.zones.end());
+	opts.zones.erase(std::unique(opts.zones.begin(), opts.zones.end()), opts.zones.end());
+
+	FILE* out = (opts.output == "-") ? stdout : std::fopen(opts.output.c_str(), "wb");
+	if (!out) {
+		std::cerr << "bitboard-enumerate: " << opts.output << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+
+	// each thread formats into its own buffer, which is written as a whole when it is full
+	const size_t buffer_size = 1 << 20;
+	std::vector<std::string> buffers(opts.threads, std::string(buffer_size + 64, '\0'));
+	std::vector<size_t> used(opts.threads, 0);
+	std::mutex output;
+	auto flush = [&](u32 id) {
+		std::lock_guard<std::mutex> lock(output);
+		std::fwrite(buffers[id].data(), 1, used[id], out);
+		used[id] = 0;
+	};
+
+	u64 total = enumerator.run(opts.zones, opts.threads, [&](u32 id, const Zone7x7Bitboard& z) {
+		if (opts.count) return;
+		char* p = &buffers[id][used[id]];
+		used[id] = (opts.binary ? encode_record(p, z) : format_board(p, z)) - buffers[id].data();
+		if (used[id] >= buffer_size) flush(id);
+	});
+	for (u32 id = 0; id < opts.threads; id++) flush(id);
+	if (opts.count) std::fprintf(out, "%llu\n", static_cast<unsigned long long>(total));
+
+	if (std::fflush(out) != 0 || (out != stdout && std::fclose(out) != 0)) {
+		std::cerr << "bitboard-enumerate: " << opts.output << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	return 0;
+}
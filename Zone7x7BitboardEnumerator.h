@@ -0,0 +1,219 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardRanking.h"
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cassert>
+
+/**
+ * enumerate the distinct boards of R-zones, i.e., one normalized board for each class of isomorphic boards
+ *
+ * a zone is normalized first, and the isomorphisms that map the normalized zone onto itself (optionally after slide())
+ * are its symmetry; a coloring of the zone is emitted only if it is not larger than any of its symmetric colorings,
+ * so the emitted boards are exactly the results of normalize(), without generating and deduplicating the others.
+ *
+ * the colorings of a zone are ranges of base-3 numbers (see Zone7x7BitboardRanking), which are processed by
+ * a work-stealing thread pool: a worker splits its range in halves and keeps the smaller pieces in its own queue,
+ * while an idle worker steals the largest pieces from the others.
+ */
+class Zone7x7BitboardEnumerator {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+
+	static constexpr u32 MAX_CELLS = 40; // the maximum locations of a zone, since 3^40 < 2^64 < 3^41
+
+	/**
+	 * @param
+	 *  allow_slide set as true to enumerate the boards of normalize(true)
+	 *  valid_only  set as true to only enumerate the boards whose blocks have liberties, see Zone7x7Bitboard::valid()
+	 */
+	inline Zone7x7BitboardEnumerator(bool allow_slide = false, bool valid_only = false) : allow_slide(allow_slide), valid_only(valid_only) {}
+
+	/**
+	 * @return the normalized zone, see Zone7x7Bitboard::normalize()
+	 */
+	inline u64 canonical_zone(u64 zone) const {
+		Zone7x7Bitboard z(zone, 0, 0);
+		z.normalize(allow_slide);
+		return z.zone;
+	}
+	/**
+	 * list the normalized connected (4-connected) zones
+	 * @param
+	 *  max_cells the maximum number of locations of zones, at most MAX_CELLS
+	 * @return
+	 *  the zones with 1 to max_cells locations, in ascending order
+	 */
+	inline std::vector<u64> zones(u32 max_cells) const {
+		assert(max_cells <= MAX_CELLS);
+		std::vector<u64> list;
+		for (u32 root = 0; root < 49 && max_cells; root++) {
+			// Redelmeier's algorithm: grow the zones whose lowest location is root
+			u64 seen = (2ull << root) - 1;
+			grow(0, 1ull << root, seen, max_cells, list);
+		}
+		std::sort(list.begin(), list.end());
+		return list;
+	}
+	/**
+	 * @return the number of colorings of the zone, i.e., 3^k where k is the number of locations, at most MAX_CELLS
+	 */
+	static inline u64 colorings(u64 zone) {
+		assert(u32(__builtin_popcountll(zone)) <= MAX_CELLS);
+		u64 n = 1;
+		for (u32 k = __builtin_popcountll(zone); k; k--) n *= 3;
+		return n;
+	}
+
+	/**
+	 * enumerate the distinct boards of a range of colorings
+	 * @param
+	 *  zone   the normalized zone, see canonical_zone()
+	 *  lo, hi the range of colorings in base-3 numbers, see Zone7x7BitboardRanking::ternary()
+	 *  func   the callback of each board, as func(const Zone7x7Bitboard&)
+	 * @return
+	 *  the number of boards
+	 */
+	template<typename Func>
+	inline u64 enumerate(u64 zone, u64 lo, u64 hi, Func&& func) const {
+		Symmetry symmetry[8];
+		u32 n = 0;
+		for (u32 i = 1; i < 8; i++) {
+			Zone7x7Bitboard z(Zone7x7Bitboard::Isomorphisms::transform(zone, i), 0, 0);
+			u64 x = z.zone;
+			if (allow_slide) z.slide();
+			if (z.zone == zone) symmetry[n++] = { i, x ? u32(__builtin_ctzll(x) - __builtin_ctzll(z.zone)) : 0 };
+		}
+
+		u64 count = 0, b, w;
+		Zone7x7BitboardRanking::unternary(lo, __builtin_popcountll(zone), b, w);
+		for (u64 x = lo; x < hi; x++, Zone7x7BitboardRanking::increase(b, w)) {
+			Zone7x7Bitboard z(zone, Zone7x7Bitboard::pdep(b, zone), Zone7x7Bitboard::pdep(w, zone));
+			bool canonical = true;
+			for (u32 k = 0; k < n && canonical; k++) {
+				u64 ib = Zone7x7Bitboard::Isomorphisms::transform(z.black, symmetry[k].id) >> symmetry[k].shift;
+				u64 iw = Zone7x7Bitboard::Isomorphisms::transform(z.white, symmetry[k].id) >> symmetry[k].shift;
+				canonical = (z.black < ib) | ((z.black == ib) & (z.white <= iw));
+			}
+			if (!canonical || (valid_only && !z.valid())) continue;
+			func(z);
+			count++;
+		}
+		return count;
+	}
+	/**
+	 * enumerate the distinct boards of the given zones in parallel
+	 * @param
+	 *  zones   the zones, which are normalized before enumerating
+	 *  threads the number of threads
+	 *  func    the callback of each board, as func(u32 thread, const Zone7x7Bitboard&), where thread is in [0, threads)
+	 * @return
+	 *  the number of boards
+	 */
+	template<typename Func>
+	inline u64 run(const std::vector<u64>& zones, u32 threads, Func&& func) const {
+		threads = std::max(threads, 1u);
+		std::vector<Queue> queues(threads);
+		std::atomic<u64> pending(0), total(0);
+		for (size_t i = 0; i < zones.size(); i++) {
+			u64 zone = canonical_zone(zones[i]);
+			queues[i % threads].tasks.push_back({ zone, 0, colorings(zone) });
+			pending++;
+		}
+
+		auto work = [&](u32 id) {
+			u64 count = 0;
+			for (Task task; pending.load() != 0; ) {
+				if (!take(queues, id, task)) {
+					std::this_thread::yield();
+					continue;
+				}
+				while (task.hi - task.lo > GRAIN) {
+					u64 mid = task.lo + (task.hi - task.lo) / 2;
+					pending++;
+					queues[id].push({ task.zone, mid, task.hi });
+					task.hi = mid;
+				}
+				count += enumerate(task.zone, task.lo, task.hi, [&](const Zone7x7Bitboard& z) { func(id, z); });
+				pending--;
+			}
+			total += count;
+		};
+		std::vector<std::thread> workers;
+		for (u32 id = 1; id < threads; id++) workers.emplace_back(work, id);
+		work(0);
+		for (std::thread& worker : workers) worker.join();
+		return total;
+	}
+
+protected:
+	static constexpr u64 GRAIN = 1 << 14; // the maximum colorings of a task
+
+	struct Symmetry {
+		u32 id;    // the isomorphic id number
+		u32 shift; // the shift of slide() after the isomorphism
+	};
+
+	struct Task {
+		u64 zone;
+		u64 lo, hi;
+	};
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+
+		inline void push(const Task& task) {
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push_back(task);
+		}
+		inline bool pop(Task& task) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (tasks.empty()) return false;
+			task = tasks.back();
+			tasks.pop_back();
+			return true;
+		}
+		inline bool steal(Task& task) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (tasks.empty()) return false;
+			task = tasks.front();
+			tasks.pop_front();
+			return true;
+		}
+	};
+	/**
+	 * take a task from the back of the own queue, or steal one from the front of the others
+	 */
+	static inline bool take(std::vector<Queue>& queues, u32 id, Task& task) {
+		if (queues[id].pop(task)) return true;
+		for (size_t i = 1; i < queues.size(); i++) {
+			if (queues[(id + i) % queues.size()].steal(task)) return true;
+		}
+		return false;
+	}
+
+	/**
+	 * add each untried location to the zone, and grow further with the new neighbors
+	 */
+	inline void grow(u64 zone, u64 untried, u64 seen, u32 max_cells, std::vector<u64>& list) const {
+		for (; untried; untried &= untried - 1) {
+			u64 next = zone | (untried & -untried);
+			if (canonical_zone(next) == next) list.push_back(next);
+			if (u32(__builtin_popcountll(next)) == max_cells) continue;
+			u64 fresh = Zone7x7Bitboard::neighbors(untried & -untried) & ~seen;
+			grow(next, (untried & (untried - 1)) | fresh, seen | fresh, max_cells, list);
+		}
+	}
+
+protected:
+	bool allow_slide;
+	bool valid_only;
+};
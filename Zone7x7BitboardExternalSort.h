@@ -0,0 +1,569 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardArray.h"
+#include "Zone7x7BitboardIO.h"
+#include <string>
+#include <vector>
+#include <future>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+/**
+ * an external-memory pipeline that normalizes, sorts, and deduplicates more boards than fit in memory
+ *
+ * the boards are collected into runs, each run is normalized (see Zone7x7Bitboard::normalize_batch()),
+ * sorted and deduplicated (see Zone7x7BitboardArray::dedup()), and spilled to an unlinked temporary file,
+ * while the next run is being collected. the runs are finally merged by a loser tree, and the duplicates
+ * across runs are removed, so the boards are emitted in the order of Zone7x7Bitboard::operator<().
+ *
+ * a spilled run is compressed record by record against the previous one (which has a smaller or equal zone),
+ * where the stones are gathered into the bits of the zone (i.e., pext), as unsigned LEB128 varints:
+ *   (zone delta << 2 | tag), then
+ *   zone, black, and white as they are,            if escaped (tag 2, the zone delta does not fit in 62 bits)
+ *   black and white as they are,                   if irregular (tag 1, a stone outside the zone)
+ *   the delta of black, then white or its delta,   if the zone is unchanged and the previous one is regular
+ *   black and white,                               otherwise (tag 0)
+ * where white is written as a delta only if black is unchanged, and the zone delta of an escaped record is 0.
+ *
+ * all file I/O is double-buffered, i.e., a block is read or written in background while the other is processed
+ */
+class Zone7x7BitboardExternalSort {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+
+	static constexpr size_t RECORD_SIZE = Zone7x7BitboardIO::RECORD_SIZE;
+	static constexpr size_t MAX_ENCODED = 31; // the maximum size of a compressed record, i.e., an escaped one
+	static constexpr size_t MAX_FANIN = 256;  // the maximum runs merged at once, more runs are merged in passes
+
+	/**
+	 * a sequential reader of a file descriptor, which reads the next block in background
+	 */
+	class BlockReader {
+	public:
+		static constexpr size_t HEADROOM = 64; // the maximum bytes kept from the previous block, see next()
+
+		inline BlockReader(int fd, size_t block) : fd(fd), block(block), index(0), last(nullptr), error_code(0) {
+			buf[0].resize(HEADROOM + block);
+			buf[1].resize(HEADROOM + block);
+			fetch();
+		}
+		BlockReader(const BlockReader&) = delete;
+		BlockReader& operator =(const BlockReader&) = delete;
+		inline ~BlockReader() { if (pending.valid()) pending.wait(); }
+
+		/**
+		 * get the next block, the last keep bytes of the current block are copied in front of it,
+		 * so that a record across the boundary can be parsed as a whole
+		 * @param
+		 *  data the beginning of the kept bytes, followed by the bytes of the next block
+		 *  keep the number of bytes to be kept, at most HEADROOM
+		 * @return
+		 *  the number of bytes read (excluding the kept bytes), or 0 at the end of file or on error
+		 */
+		inline size_t next(const char*& data, size_t keep = 0) {
+			ssize_t n = pending.valid() ? pending.get() : 0;
+			if (n < 0) error_code = -n;
+			char* head = buf[index].data() + HEADROOM - keep;
+			if (keep) std::memmove(head, last - keep, keep);
+			data = head;
+			last = head + keep + std::max<ssize_t>(n, 0);
+			index ^= 1;
+			if (n > 0) fetch();
+			return std::max<ssize_t>(n, 0);
+		}
+		/**
+		 * @return the errno of the failed read, or 0 if there is no error
+		 */
+		inline int error() const { return error_code; }
+
+	protected:
+		inline void fetch() {
+			char* p = buf[index].data() + HEADROOM;
+			pending = std::async(std::launch::async, [this, p]() -> ssize_t {
+				size_t n = 0;
+				while (n < block) {
+					ssize_t r = ::read(fd, p + n, block - n);
+					if (r < 0 && errno == EINTR) continue;
+					if (r < 0) return -errno;
+					if (r == 0) break;
+					n += r;
+				}
+				return n;
+			});
+		}
+
+	protected:
+		int fd;
+		size_t block;
+		std::vector<char> buf[2];
+		u32 index;            // the buffer being filled in background
+		const char* last;     // the end of the current block
+		int error_code;
+		std::future<ssize_t> pending;
+	};
+
+	/**
+	 * a sequential writer of a file descriptor, which writes the filled block in background
+	 */
+	class BlockWriter {
+	public:
+		inline BlockWriter(int fd, size_t block) : fd(fd), block(block), index(0), used(0), error_code(0) {
+			buf[0].resize(block);
+			buf[1].resize(block);
+		}
+		BlockWriter(const BlockWriter&) = delete;
+		BlockWriter& operator =(const BlockWriter&) = delete;
+		inline ~BlockWriter() { wait(); }
+
+		/**
+		 * reserve space for at most n bytes (n <= block), write them, and then commit() their end
+		 * @return
+		 *  the beginning of the space
+		 */
+		inline char* reserve(size_t n) {
+			if (used + n > block) flush();
+			return buf[index].data() + used;
+		}
+		inline void commit(char* end) { used = end - buf[index].data(); }
+
+		/**
+		 * write the current block in background
+		 */
+		inline void flush() {
+			wait();
+			if (!used) return;
+			const char* p = buf[index].data();
+			size_t n = used;
+			pending = std::async(std::launch::async, [this, p, n]() -> int {
+				for (size_t k = 0; k < n; ) {
+					ssize_t r = ::write(fd, p + k, n - k);
+					if (r < 0 && errno == EINTR) continue;
+					if (r < 0) return errno;
+					k += r;
+				}
+				return 0;
+			});
+			index ^= 1;
+			used = 0;
+		}
+		/**
+		 * write all pending blocks and wait for them
+		 * @return
+		 *  the errno of the failed write, or 0 if there is no error
+		 */
+		inline int finish() {
+			flush();
+			wait();
+			return error_code;
+		}
+
+	protected:
+		inline void wait() {
+			if (!pending.valid()) return;
+			int e = pending.get();
+			error_code = error_code ? error_code : e;
+		}
+
+	protected:
+		int fd;
+		size_t block;
+		std::vector<char> buf[2];
+		u32 index; // the buffer being filled
+		size_t used;
+		int error_code;
+		std::future<int> pending;
+	};
+
+public:
+	/**
+	 * @param
+	 *  memory      the memory budget in bytes, which is shared by two runs and the merge buffers
+	 *  temp        the directory of temporary files
+	 *  normalize   set as false to sort and deduplicate the boards as they are
+	 *  allow_slide set as true to invoke slide() for all isomorphisms, see Zone7x7Bitboard::normalize()
+	 */
+	inline Zone7x7BitboardExternalSort(size_t memory = size_t(1) << 30, const std::string& temp = "/tmp",
+	                                   bool normalize = true, bool allow_slide = false)
+		: memory(memory), temp(temp), normalize(normalize), allow_slide(allow_slide), total(0) {
+		// a run takes 48 bytes per board, i.e., the columns and the buffers of sort(), and 2 runs are alive
+		run_size = std::max<size_t>(memory / (2 * 2 * RECORD_SIZE), 1024);
+		current.reserve(run_size);
+	}
+	Zone7x7BitboardExternalSort(const Zone7x7BitboardExternalSort&) = delete;
+	Zone7x7BitboardExternalSort& operator =(const Zone7x7BitboardExternalSort&) = delete;
+	inline ~Zone7x7BitboardExternalSort() {
+		collect();
+		for (const Run& run : runs) ::close(run.fd);
+	}
+
+	/**
+	 * add a board, the current run is spilled in background when it is full
+	 */
+	inline void push_back(const Zone7x7Bitboard& z) {
+		current.push_back(z);
+		total++;
+		if (current.size() >= run_size) spill_async();
+	}
+	/**
+	 * add boards from binary records, see Zone7x7BitboardIO::decode_record()
+	 * @param
+	 *  data the records
+	 *  n    the number of records
+	 */
+	inline void push_records(const char* data, size_t n) {
+		for (size_t i = 0; i < n; i++) push_back(Zone7x7BitboardIO::decode_record(data + i * RECORD_SIZE));
+	}
+
+	/**
+	 * merge all runs, and emit the distinct boards in ascending order
+	 * no board should be added after merging
+	 * @param
+	 *  func the callback of each board, as func(const Zone7x7Bitboard&)
+	 * @return
+	 *  the number of emitted boards, check good() or error() for the result
+	 */
+	template<typename Func>
+	inline u64 merge(Func&& func) {
+		collect();
+		if (!good()) return 0;
+		if (runs.empty()) { // all boards fit in memory
+			prepare(current);
+			for (size_t i = 0; i < current.size(); i++) func(current[i]);
+			return current.size();
+		}
+		if (current.size()) {
+			runs.push_back(spill(current));
+			current.clear();
+		}
+		// merge the runs in passes until at most MAX_FANIN runs are left
+		while (good() && runs.size() > MAX_FANIN) {
+			std::vector<Run> group(runs.begin(), runs.begin() + MAX_FANIN), rest(runs.begin() + MAX_FANIN, runs.end());
+			runs.swap(rest);
+			runs.push_back(combine(group));
+		}
+		if (!good()) return 0;
+		u64 count = merge(runs, func);
+		runs.clear();
+		return count;
+	}
+
+	/**
+	 * @return the number of added boards
+	 */
+	inline u64 size() const { return total; }
+	/**
+	 * @return the number of spilled runs that are not merged yet
+	 */
+	inline size_t spilled() const { return runs.size() + (pending.valid() ? 1 : 0); }
+
+	inline bool good() const { return err.empty(); }
+	inline const std::string& error() const { return err; }
+
+protected:
+	/**
+	 * a sorted run in an unlinked temporary file
+	 */
+	struct Run {
+		int fd;
+		u64 count;
+		int error; // the errno if fd is -1
+	};
+
+	/**
+	 * the state of the compression, i.e., the previous record
+	 */
+	struct Codec {
+		enum Tag { REGULAR = 0, IRREGULAR = 1, ESCAPED = 2 };
+
+		u64 zone = 0;
+		u64 black = 0; // gathered into the bits of zone if regular
+		u64 white = 0; // gathered into the bits of zone if regular
+		bool regular = false;
+
+		static inline char* put(char* out, u64 x) {
+			for (; x >= 0x80; x >>= 7) *(out++) = char(x | 0x80);
+			*(out++) = char(x);
+			return out;
+		}
+		/**
+		 * read a varint that ends before end
+		 * @return
+		 *  false if the varint is truncated or longer than 64 bits
+		 */
+		static inline bool get(const char*& in, const char* end, u64& x) {
+			x = 0;
+			for (u32 shift = 0; in != end && shift < 64; shift += 7) {
+				u64 b = static_cast<unsigned char>(*(in++));
+				x |= (b & 0x7f) << shift;
+				if (b < 0x80) return true;
+			}
+			return false;
+		}
+
+		inline char* encode(char* out, const Zone7x7Bitboard& z) {
+			const u64 delta = z.zone - zone;
+			if (delta >> 62) { // the tag would overflow the token
+				out = put(out, ESCAPED);
+				out = put(out, z.zone);
+				out = put(out, z.black);
+				out = put(out, z.white);
+				*this = { z.zone, z.black, z.white, false };
+				return out;
+			}
+			const bool irregular = (z.black | z.white) & ~z.zone;
+			out = put(out, (delta << 2) | (irregular ? IRREGULAR : REGULAR));
+			if (irregular) {
+				out = put(out, z.black);
+				out = put(out, z.white);
+				*this = { z.zone, z.black, z.white, false };
+				return out;
+			}
+			u64 b = Zone7x7Bitboard::pext(z.black, z.zone), w = Zone7x7Bitboard::pext(z.white, z.zone);
+			if (z.zone == zone && regular) {
+				out = put(out, b - black);
+				out = put(out, b == black ? w - white : w);
+			} else {
+				out = put(out, b);
+				out = put(out, w);
+			}
+			*this = { z.zone, b, w, true };
+			return out;
+		}
+		/**
+		 * decode a record that ends before end
+		 * @return
+		 *  false if the record is truncated or corrupt
+		 */
+		inline bool decode(const char*& in, const char* end, Zone7x7Bitboard& board) {
+			u64 token, z, b, w;
+			if (!get(in, end, token)) return false;
+			switch (token & 3) {
+			case ESCAPED:
+				if ((token >> 2) || !get(in, end, z) || !get(in, end, b) || !get(in, end, w)) return false;
+				*this = { z, b, w, false };
+				board = { z, b, w };
+				return true;
+			case IRREGULAR:
+				z = zone + (token >> 2);
+				if (!get(in, end, b) || !get(in, end, w)) return false;
+				*this = { z, b, w, false };
+				board = { z, b, w };
+				return true;
+			case REGULAR:
+				z = zone + (token >> 2);
+				if (!get(in, end, b) || !get(in, end, w)) return false;
+				if (z == zone && regular) {
+					b += black;
+					w += (b == black ? white : 0);
+				}
+				*this = { z, b, w, true };
+				board = { z, Zone7x7Bitboard::pdep(b, z), Zone7x7Bitboard::pdep(w, z) };
+				return true;
+			default:
+				return false;
+			}
+		}
+	};
+
+	/**
+	 * a reading position of a run
+	 */
+	struct Cursor {
+		BlockReader reader;
+		const char* p;
+		const char* end;
+		u64 left;
+		bool eof;
+		bool corrupt; // a record is truncated or corrupt
+		Codec codec;
+		Zone7x7Bitboard board;
+
+		inline Cursor(const Run& run, size_t block) : reader(run.fd, block), p(nullptr), end(nullptr), left(run.count), eof(false), corrupt(false) {}
+		/**
+		 * decode the next board
+		 * @return
+		 *  false if the run is exhausted, truncated, or corrupt
+		 */
+		inline bool advance() {
+			if (!left || corrupt) return false;
+			if (size_t(end - p) < MAX_ENCODED && !eof) {
+				size_t keep = end - p, n = reader.next(p, keep);
+				end = p + keep + n;
+				eof = (n == 0);
+			}
+			if (p == end) return false; // truncated
+			if (!codec.decode(p, end, board)) {
+				corrupt = true;
+				return false;
+			}
+			left--;
+			return true;
+		}
+	};
+
+	/**
+	 * normalize, sort, and deduplicate the boards of a run
+	 */
+	inline void prepare(Zone7x7BitboardArray& boards) const {
+		if (normalize) boards.normalize(allow_slide);
+		boards.dedup();
+	}
+
+	/**
+	 * create an unlinked temporary file
+	 * @return
+	 *  the file descriptor, or -1 on error
+	 */
+	inline int create() const {
+		std::string path = temp + "/bitboard-sort-XXXXXX";
+		int fd = ::mkstemp(&path[0]);
+		if (fd >= 0) ::unlink(path.c_str());
+		return fd;
+	}
+	/**
+	 * prepare and write a run into a temporary file, note that it may be invoked in background
+	 * @return
+	 *  the run, whose fd is -1 on error
+	 */
+	inline Run spill(Zone7x7BitboardArray& boards) const {
+		prepare(boards);
+		Run run = { create(), boards.size(), 0 };
+		if (run.fd < 0) {
+			run.error = errno;
+			return run;
+		}
+		BlockWriter writer(run.fd, block_size(1));
+		Codec codec;
+		for (size_t i = 0; i < boards.size(); i++) {
+			writer.commit(codec.encode(writer.reserve(MAX_ENCODED), boards[i]));
+		}
+		if ((run.error = writer.finish()) != 0) {
+			::close(run.fd);
+			run.fd = -1;
+		}
+		return run;
+	}
+	/**
+	 * spill the current run in background, after the previous one is done
+	 */
+	inline void spill_async() {
+		collect();
+		std::swap(spare, current);
+		current.clear();
+		current.reserve(run_size);
+		pending = std::async(std::launch::async, [this]() { return spill(spare); });
+	}
+	/**
+	 * wait for the run being spilled in background
+	 */
+	inline void collect() {
+		if (!pending.valid()) return;
+		Run run = pending.get();
+		spare.clear();
+		if (run.fd < 0) {
+			err = temp + ": " + std::strerror(run.error);
+			return;
+		}
+		runs.push_back(run);
+	}
+
+	/**
+	 * @return the block size of each buffer, when the given number of runs are merged
+	 */
+	inline size_t block_size(size_t fanin) const {
+		size_t block = memory / (4 * (fanin + 1)); // 2 buffers of each run and of the output
+		return std::min<size_t>(std::max<size_t>(block, 1 << 16), 1 << 22);
+	}
+
+	/**
+	 * merge the given runs into a new run
+	 */
+	inline Run combine(const std::vector<Run>& group) {
+		Run run = { create(), 0, 0 };
+		if (run.fd < 0) {
+			err = temp + ": " + std::strerror(errno);
+			return run;
+		}
+		BlockWriter writer(run.fd, block_size(group.size()));
+		Codec codec;
+		run.count = merge(group, [&](const Zone7x7Bitboard& z) {
+			writer.commit(codec.encode(writer.reserve(MAX_ENCODED), z));
+		});
+		if ((run.error = writer.finish()) != 0) err = temp + ": " + std::strerror(run.error);
+		return run;
+	}
+	/**
+	 * merge the given runs by a loser tree, and close them
+	 * tree[0] is the winner, and tree[1, k) are the losers of the internal nodes,
+	 * where the leaves are the (virtual) nodes [k, 2k), i.e., the parent of run i is (i + k) / 2
+	 */
+	template<typename Func>
+	inline u64 merge(const std::vector<Run>& group, Func&& func) {
+		const u32 k = group.size();
+		std::vector<std::unique_ptr<Cursor>> cursor;
+		std::vector<bool> done(k);
+		for (u32 i = 0; i < k; i++) {
+			::lseek(group[i].fd, 0, SEEK_SET); // before the first block is read
+			cursor.emplace_back(new Cursor(group[i], block_size(k)));
+		}
+		for (u32 i = 0; i < k; i++) done[i] = !cursor[i]->advance();
+
+		// i beats j, where k is a virtual run smaller than all boards, and exhausted runs are larger than all boards
+		auto beats = [&](u32 i, u32 j) {
+			if (i == k || j == k) return i == k;
+			if (done[i] || done[j]) return !done[i];
+			return cursor[i]->board < cursor[j]->board;
+		};
+		std::vector<u32> tree(std::max(k, 1u), k);
+		auto adjust = [&](u32 i) {
+			for (u32 t = (i + k) / 2; t > 0; t /= 2) {
+				if (beats(tree[t], i)) std::swap(tree[t], i);
+			}
+			tree[0] = i;
+		};
+		for (u32 i = k; i-- > 0; ) adjust(i);
+
+		u64 count = 0;
+		Zone7x7Bitboard last;
+		while (k && !done[tree[0]]) {
+			const u32 i = tree[0];
+			const Zone7x7Bitboard z = cursor[i]->board;
+			if (!count || z != last) {
+				func(z);
+				last = z;
+				count++;
+			}
+			done[i] = !cursor[i]->advance();
+			adjust(i);
+		}
+		for (u32 i = 0; i < k; i++) {
+			if (cursor[i]->corrupt && good()) err = temp + ": corrupt run";
+			if (cursor[i]->left && good()) err = temp + ": truncated run";
+			if (cursor[i]->reader.error() && good()) err = temp + ": " + std::strerror(cursor[i]->reader.error());
+			cursor[i].reset();
+			::close(group[i].fd);
+		}
+		return count;
+	}
+
+protected:
+	size_t memory;
+	std::string temp;
+	bool normalize;
+	bool allow_slide;
+	size_t run_size;
+	u64 total;
+	Zone7x7BitboardArray current; // the run being collected
+	Zone7x7BitboardArray spare;   // the run being spilled in background
+	std::future<Run> pending;
+	std::vector<Run> runs;
+	std::string err;
+};
@@ -0,0 +1,235 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * input and output utilities for Zone7x7Bitboard
+ *
+ * text format: one board per line, as three numbers "zone black white",
+ *   each number can be decimal (123), octal (0173), hexadecimal (0x7b), or binary (0b1111011)
+ * binary format: one board per record, as three 64-bit little-endian words (zone, black, white)
+ */
+namespace Zone7x7BitboardIO {
+
+using u64 = Zone7x7Bitboard::u64;
+using u32 = Zone7x7Bitboard::u32;
+
+/**
+ * the size of a binary record in bytes
+ */
+static constexpr size_t RECORD_SIZE = 3 * sizeof(u64);
+
+/**
+ * a read-only view of a whole file, which is memory-mapped if possible
+ * non-regular files (e.g., pipes) are read into a buffer instead
+ */
+class MappedFile {
+public:
+	/**
+	 * open the given file, use "-" for the standard input
+	 * check good() or error() for the result
+	 */
+	inline MappedFile(const std::string& path) : ptr(nullptr), len(0), mapped(false) {
+		int fd = (path == "-") ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			err = path + ": " + std::strerror(errno);
+			return;
+		}
+		struct stat st;
+		if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+			void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p != MAP_FAILED) {
+				::madvise(p, st.st_size, MADV_SEQUENTIAL);
+				ptr = static_cast<const char*>(p);
+				len = st.st_size;
+				mapped = true;
+			}
+		}
+		if (!mapped) {
+			char chunk[1 << 16];
+			for (ssize_t n; (n = ::read(fd, chunk, sizeof(chunk))) != 0; ) {
+				if (n < 0 && errno == EINTR) continue;
+				if (n < 0) {
+					err = path + ": " + std::strerror(errno);
+					break;
+				}
+				buf.insert(buf.end(), chunk, chunk + n);
+			}
+			ptr = buf.data();
+			len = buf.size();
+		}
+		if (fd != STDIN_FILENO) ::close(fd);
+	}
+	inline ~MappedFile() { if (mapped) ::munmap(const_cast<char*>(ptr), len); }
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator =(const MappedFile&) = delete;
+
+	inline bool good() const { return err.empty(); }
+	inline const std::string& error() const { return err; }
+	inline const char* data() const { return ptr; }
+	inline size_t size() const { return len; }
+	inline const char* begin() const { return ptr; }
+	inline const char* end() const { return ptr + len; }
+
+protected:
+	const char* ptr;
+	size_t len;
+	bool mapped;
+	std::vector<char> buf;
+	std::string err;
+};
+
+/**
+ * list the entries of a directory in ascending order, hidden entries are skipped
+ * @param
+ *  path        the directory
+ *  directories set as true to list subdirectories, or false to list regular files
+ * @return
+ *  the paths of the entries
+ */
+inline std::vector<std::string> list_directory(const std::string& path, bool directories) {
+	std::vector<std::string> entries;
+	if (DIR* dir = ::opendir(path.c_str())) {
+		while (dirent* ent = ::readdir(dir)) {
+			std::string name = ent->d_name;
+			struct stat st;
+			if (name[0] == '.' || ::stat((path + "/" + name).c_str(), &st) != 0) continue;
+			if (directories ? S_ISDIR(st.st_mode) : S_ISREG(st.st_mode)) entries.push_back(path + "/" + name);
+		}
+		::closedir(dir);
+	}
+	std::sort(entries.begin(), entries.end());
+	return entries;
+}
+
+/**
+ * parse a number from [p, end), leading spaces and tabs are skipped
+ * @param
+ *  p   the current position, will be moved to the end of the number
+ *  end the end of the text
+ *  x   the parsed number
+ * @return
+ *  whether a number is parsed, false for an empty or invalid token, or a number that overflows 64 bits
+ */
+inline bool parse_number(const char*& p, const char* end, u64& x) {
+	while (p != end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+	const char* q = p;
+	u64 v = 0, overflow = 0; // the bits shifted out, or nonzero if a decimal step overflows
+	if (end - q > 2 && q[0] == '0' && (q[1] | 0x20) == 'x') {
+		for (q += 2; q != end; q++) {
+			u32 d = u32(*q - '0'), h = u32((*q | 0x20) - 'a');
+			if (d >= 10 && h >= 6) break;
+			overflow |= v >> 60;
+			v = (v << 4) | (d < 10 ? d : h + 10);
+		}
+		if (q == p + 2) return false;
+	} else if (end - q > 2 && q[0] == '0' && (q[1] | 0x20) == 'b') {
+		for (q += 2; q != end && u32(*q - '0') < 2; q++) overflow |= v >> 63, v = (v << 1) | u32(*q - '0');
+		if (q == p + 2) return false;
+	} else if (q != end && *q == '0') {
+		for (q += 1; q != end && u32(*q - '0') < 8; q++) overflow |= v >> 61, v = (v << 3) | u32(*q - '0');
+	} else {
+		for (; q != end && u32(*q - '0') < 10; q++) {
+			overflow |= __builtin_mul_overflow(v, 10, &v) | __builtin_add_overflow(v, u32(*q - '0'), &v);
+		}
+		if (q == p) return false;
+	}
+	if (overflow || (q != end && !(*q == ' ' || *q == '\t' || *q == '\r' || *q == '\n'))) return false;
+	p = q;
+	x = v;
+	return true;
+}
+
+/**
+ * parse a board from a line in [p, end), the line should contain exactly 3 numbers
+ * @param
+ *  p   the beginning of the line, will be moved to the beginning of the next line
+ *  end the end of the text
+ *  z   the parsed board
+ * @return
+ *  1 if a board is parsed, 0 for a blank line, or -1 for an invalid line
+ */
+inline int parse_board(const char*& p, const char* end, Zone7x7Bitboard& z) {
+	const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+	eol = eol ? eol : end;
+	const char* q = p;
+	p = (eol != end) ? eol + 1 : end;
+	while (q != eol && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+	if (q == eol) return 0;
+	u64 zone, black, white;
+	if (!parse_number(q, eol, zone) || !parse_number(q, eol, black) || !parse_number(q, eol, white)) return -1;
+	while (q != eol && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+	if (q != eol) return -1;
+	z = Zone7x7Bitboard(zone, black, white);
+	return 1;
+}
+
+/**
+ * format a number in decimal into the given buffer
+ * @return
+ *  the end of the formatted number
+ */
+inline char* format_number(char* out, u64 x) {
+	char digits[20];
+	u32 n = 0;
+	do {
+		digits[n++] = char('0' + x % 10);
+		x /= 10;
+	} while (x);
+	while (n) *(out++) = digits[--n];
+	return out;
+}
+
+/**
+ * format a board as a text line "zone black white\n" into the given buffer
+ * the buffer should have at least 64 bytes
+ * @return
+ *  the end of the formatted line
+ */
+inline char* format_board(char* out, const Zone7x7Bitboard& z) {
+	out = format_number(out, z.zone);
+	*(out++) = ' ';
+	out = format_number(out, z.black);
+	*(out++) = ' ';
+	out = format_number(out, z.white);
+	*(out++) = '\n';
+	return out;
+}
+
+/**
+ * encode a board as a binary record into the given buffer
+ * @return
+ *  the end of the record
+ */
+inline char* encode_record(char* out, const Zone7x7Bitboard& z) {
+	const u64 words[3] = { z.zone, z.black, z.white };
+	for (u64 w : words) {
+		for (u32 i = 0; i < 8; i++) *(out++) = char(w >> (i * 8));
+	}
+	return out;
+}
+
+/**
+ * decode a board from a binary record
+ * @return
+ *  the decoded board
+ */
+inline Zone7x7Bitboard decode_record(const char* in) {
+	u64 words[3] = {};
+	for (u64& w : words) {
+		for (u32 i = 0; i < 8; i++) w |= u64(static_cast<unsigned char>(*(in++))) << (i * 8);
+	}
+	return { words[0], words[1], words[2] };
+}
+
+} // namespace Zone7x7BitboardIO
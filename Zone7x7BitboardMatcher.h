@@ -0,0 +1,246 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include <vector>
+#include <algorithm>
+
+/**
+ * an index of R-zone patterns, which finds all patterns contained in a board
+ *
+ * a pattern (zone, black, white) is contained in a board if the board has exactly the same pieces within the zone,
+ * i.e., the zone is relevant in the board, (board.black & zone) == black, and (board.white & zone) == white.
+ * all isomorphisms of each pattern are stored as variants, as well as all their translations that keep
+ * the borders touched by the zone unchanged (i.e., the translations that slide() may undo) if allow_slide is set.
+ *
+ * the variants are indexed by a decision trie: each node tests a location, and has 4 children for the variants
+ * that require the location to be empty, black, or white, and for those that do not care about the location;
+ * the tested location is the one required by the most variants of the node, and the leaves are verified by masks.
+ * a query only visits the child of the board's piece and the don't-care child of each node.
+ */
+class Zone7x7BitboardMatcher {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+
+	/**
+	 * a variant of a pattern, which is also the result of a match
+	 */
+	struct Match {
+		Zone7x7Bitboard board; // the pattern after transform(iso) and the translation
+		u32 pattern;           // the index of the pattern
+		u32 iso;               // the isomorphic id number
+		int dx, dy;            // the translation after transform(iso)
+	};
+
+public:
+	/**
+	 * build the index of the given patterns
+	 * @param
+	 *  patterns    the patterns, whose indices are reported by matches
+	 *  n           the number of patterns
+	 *  allow_slide set as true to also match the translations of patterns, see slide()
+	 */
+	inline Zone7x7BitboardMatcher(const Zone7x7Bitboard* patterns, size_t n, bool allow_slide = false) {
+		for (size_t i = 0; i < n; i++) {
+			size_t first = variants.size();
+			for (u32 iso = 0; iso < 8; iso++) {
+				Zone7x7Bitboard z = patterns[i];
+				z.transform(iso);
+				Range rows = allow_slide ? range(z.zone, 7, 1) : Range{ 0, 0 };
+				Range cols = allow_slide ? range(z.zone, 1, 7) : Range{ 0, 0 };
+				for (int dy = rows.lo; dy <= rows.hi; dy++) {
+					for (int dx = cols.lo; dx <= cols.hi; dx++) {
+						int shift = dy * 7 + dx;
+						Match v = { shift >= 0 ? z << shift : z >> -shift, u32(i), iso, dx, dy };
+						// skip the duplicated placements of symmetric patterns
+						auto same = [&](const Match& m) { return m.board == v.board; };
+						if (std::none_of(variants.begin() + first, variants.end(), same)) variants.push_back(v);
+					}
+				}
+			}
+		}
+		std::vector<u32> ids(variants.size());
+		for (u32 i = 0; i < ids.size(); i++) ids[i] = i;
+		build(ids, 0);
+	}
+	/**
+	 * build the index of the given patterns, see Zone7x7BitboardMatcher(patterns, n, allow_slide)
+	 */
+	inline Zone7x7BitboardMatcher(const std::vector<Zone7x7Bitboard>& patterns, bool allow_slide = false)
+		: Zone7x7BitboardMatcher(patterns.data(), patterns.size(), allow_slide) {}
+
+	/**
+	 * @return the number of indexed variants
+	 */
+	inline size_t size() const { return variants.size(); }
+
+	/**
+	 * find all variants contained in the given board
+	 * @param
+	 *  board the board, whose locations outside the zone do not match any pattern location
+	 *  func  the callback of each match, as func(const Match&)
+	 */
+	template<typename Func>
+	inline void match(const Zone7x7Bitboard& board, Func&& func) const {
+		u32 stack[256], top = 0;
+		stack[top++] = 0;
+		while (top) {
+			const Node& node = nodes[stack[--top]];
+			if (node.cell == LEAF) {
+				for (u32 i = node.next[0]; i < node.next[0] + node.next[1]; i++) {
+					const Match& v = variants[order[i]];
+					if (contains(board, v.board)) func(v);
+				}
+				continue;
+			}
+			const u64 bit = 1ull << node.cell;
+			if (node.next[DONT_CARE]) stack[top++] = node.next[DONT_CARE];
+			u32 piece = (board.black & bit) ? BLACK : (board.white & bit) ? WHITE : (board.zone & bit) ? EMPTY : DONT_CARE;
+			if (piece != DONT_CARE && node.next[piece]) stack[top++] = node.next[piece];
+		}
+	}
+	/**
+	 * find all variants contained in the given board
+	 * @return
+	 *  the matches in an unspecified order
+	 */
+	inline std::vector<Match> match(const Zone7x7Bitboard& board) const {
+		std::vector<Match> matches;
+		match(board, [&](const Match& m) { matches.push_back(m); });
+		return matches;
+	}
+	/**
+	 * find all variants contained in each of the given boards, the boards are matched in groups of 64,
+	 * so that each visited node is shared by all boards of a group that reach it
+	 * @param
+	 *  boards the boards
+	 *  n      the number of boards
+	 *  func   the callback of each match, as func(size_t index, const Match&) where index is the board index
+	 */
+	template<typename Func>
+	inline void match_batch(const Zone7x7Bitboard* boards, size_t n, Func&& func) const {
+		for (size_t base = 0; base < n; base += 64) {
+			const u32 size = std::min<size_t>(n - base, 64);
+			const Zone7x7Bitboard* group = boards + base;
+			// planes[c][p] is the set of boards with piece p at location c
+			u64 planes[49][3] = {};
+			for (u32 k = 0; k < size; k++) {
+				const Zone7x7Bitboard& z = group[k];
+				for (u64 x = z.zone | z.black | z.white; x; x &= x - 1) {
+					u32 c = __builtin_ctzll(x);
+					u32 piece = (z.black & (x & -x)) ? BLACK : (z.white & (x & -x)) ? WHITE : EMPTY;
+					planes[c][piece] |= 1ull << k;
+				}
+			}
+
+			struct Visit { u32 node; u64 active; } stack[256];
+			u32 top = 0;
+			stack[top++] = { 0, size == 64 ? ~0ull : ((1ull << size) - 1) };
+			while (top) {
+				const Visit visit = stack[--top];
+				const Node& node = nodes[visit.node];
+				if (node.cell == LEAF) {
+					for (u32 i = node.next[0]; i < node.next[0] + node.next[1]; i++) {
+						const Match& v = variants[order[i]];
+						for (u64 active = visit.active; active; active &= active - 1) {
+							u32 k = __builtin_ctzll(active);
+							if (contains(group[k], v.board)) func(base + k, v);
+						}
+					}
+					continue;
+				}
+				if (node.next[DONT_CARE]) stack[top++] = { node.next[DONT_CARE], visit.active };
+				for (u32 piece = EMPTY; piece <= WHITE; piece++) {
+					u64 active = visit.active & planes[node.cell][piece];
+					if (active && node.next[piece]) stack[top++] = { node.next[piece], active };
+				}
+			}
+		}
+	}
+
+protected:
+	enum { EMPTY = 0, BLACK = 1, WHITE = 2, DONT_CARE = 3 };
+	static constexpr u32 LEAF = 64;
+	static constexpr size_t LEAF_SIZE = 4; // the maximum variants of a leaf that is not split further
+
+	/**
+	 * a node of the trie, next[] are the indices of children (0 for none) if cell is a location,
+	 * or the range of order[] as next[0] (the first) and next[1] (the count) if cell is LEAF
+	 */
+	struct Node {
+		u32 cell;
+		u32 next[4];
+	};
+
+	struct Range {
+		int lo, hi;
+	};
+	/**
+	 * calculate the translations of a zone along an axis that keep the touched borders,
+	 * i.e., the zone can be moved only if it touches neither the lowest nor the highest line
+	 * @param
+	 *  zone   the zone
+	 *  stride the distance between lines (7 for rows, 1 for columns)
+	 *  step   the distance between locations of a line (1 for rows, 7 for columns)
+	 */
+	static inline Range range(u64 zone, u32 stride, u32 step) {
+		u32 lo = 7, hi = 0;
+		for (u32 i = 0; i < 7; i++) {
+			u64 line = 0;
+			for (u32 j = 0; j < 7; j++) line |= 1ull << (i * stride + j * step);
+			if (!(zone & line)) continue;
+			lo = std::min(lo, i);
+			hi = std::max(hi, i);
+		}
+		if (lo == 7 || lo == 0 || hi == 6) return { 0, 0 };
+		return { 1 - int(lo), 5 - int(hi) };
+	}
+
+	static inline bool contains(const Zone7x7Bitboard& board, const Zone7x7Bitboard& pattern) {
+		return !(pattern.zone & ~board.zone) & ((board.black & pattern.zone) == pattern.black) & ((board.white & pattern.zone) == pattern.white);
+	}
+
+	/**
+	 * build the subtrie of the given variants
+	 * @param
+	 *  ids    the indices of variants
+	 *  tested the locations tested by the ancestors
+	 * @return
+	 *  the index of the node
+	 */
+	inline u32 build(const std::vector<u32>& ids, u64 tested) {
+		u32 index = nodes.size();
+		nodes.push_back({ LEAF, { u32(order.size()), u32(ids.size()), 0, 0 } });
+
+		u32 count[49] = {};
+		for (u32 id : ids) {
+			for (u64 x = variants[id].board.zone & ~tested; x; x &= x - 1) count[__builtin_ctzll(x)]++;
+		}
+		u32 cell = std::max_element(count, count + 49) - count;
+		if (ids.size() <= LEAF_SIZE || count[cell] == 0) {
+			order.insert(order.end(), ids.begin(), ids.end());
+			return index;
+		}
+
+		std::vector<u32> part[4];
+		const u64 bit = 1ull << cell;
+		for (u32 id : ids) {
+			const Zone7x7Bitboard& z = variants[id].board;
+			u32 piece = !(z.zone & bit) ? DONT_CARE : (z.black & bit) ? BLACK : (z.white & bit) ? WHITE : EMPTY;
+			part[piece].push_back(id);
+		}
+		Node node = { cell, { 0, 0, 0, 0 } };
+		for (u32 piece = 0; piece < 4; piece++) {
+			if (part[piece].size()) node.next[piece] = build(part[piece], tested | bit);
+		}
+		nodes[index] = node;
+		return index;
+	}
+
+protected:
+	std::vector<Match> variants;
+	std::vector<Node> nodes;
+	std::vector<u32> order; // the variant indices of leaves
+};
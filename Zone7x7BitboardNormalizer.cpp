@@ -0,0 +1,212 @@
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardIO.h"
+#include "Zone7x7BitboardBackends.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <unordered_set>
+
+using u64 = Zone7x7Bitboard::u64;
+using u32 = Zone7x7Bitboard::u32;
+using namespace Zone7x7BitboardIO;
+
+static const char* usage =
+	"Usage: bitboard-normalizer [OPTION]... [FILE]...\n"
+	"Normalize the boards (one \"zone black white\" per line) of FILEs, or the standard input.\n"
+	"Numbers can be decimal, octal (0...), hexadecimal (0x...), or binary (0b...).\n"
+	"\n"
+	"  -o, --output FILE   write to FILE instead of the standard output\n"
+	"  -j, --threads N     use N threads, default is the number of CPUs\n"
+	"  -s, --slide         invoke slide() for all isomorphisms, i.e., normalize(true)\n"
+	"  -d, --dedup         only output the first occurrence of each normalized board\n"
+	"  -b, --binary        output binary records (zone, black, white as 64-bit little-endian)\n"
+	"  -r, --render        render the input and the normalized boards side by side\n"
+	"      --self-test     verify that all transformation backends agree, and exit\n"
+#if defined(ZONE7X7_STATS)
+	"      --stats         print the normalization statistics as JSON to the standard error\n"
+#endif
+	"  -h, --help          display this help and exit\n";
+
+struct Options {
+	std::vector<std::string> inputs;
+	std::string output = "-";
+	u32 threads = std::max(1u, std::thread::hardware_concurrency());
+	bool slide = false;
+	bool dedup = false;
+	bool binary = false;
+	bool render = false;
+	bool stats = false;
+};
+
+/**
+ * a chunk of complete lines, which is parsed, normalized, and formatted by a single thread
+ */
+struct Chunk {
+	const char* begin;
+	const char* end;
+	const char* error; // the beginning of the first invalid line, or nullptr
+	std::vector<Zone7x7Bitboard> input;
+	std::vector<Zone7x7Bitboard> output;
+	std::string text;
+};
+
+/**
+ * invoke func(i) for all i in [0, n) with the given number of threads
+ */
+template<typename Func>
+static void parallel_for(size_t n, u32 threads, Func func) {
+	std::atomic<size_t> next(0);
+	auto work = [&]() {
+		for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n; ) func(i);
+	};
+	std::vector<std::thread> workers;
+	for (u32 t = 1; t < std::min<size_t>(threads, n); t++) workers.emplace_back(work);
+	work();
+	for (std::thread& worker : workers) worker.join();
+}
+
+static void parse(Chunk& chunk, const Options& opts) {
+	chunk.input.clear();
+	chunk.error = nullptr;
+	for (const char* p = chunk.begin; p != chunk.end; ) {
+		const char* line = p;
+		Zone7x7Bitboard z;
+		int n = parse_board(p, chunk.end, z);
+		if (n < 0) {
+			chunk.error = line;
+			break;
+		}
+		if (n > 0) chunk.input.push_back(z);
+	}
+	chunk.output = chunk.input;
+	Zone7x7Bitboard::normalize_batch(chunk.output.data(), chunk.output.size(), opts.slide);
+}
+
+static void format(Chunk& chunk, const Options& opts) {
+	chunk.text.clear();
+	if (opts.render) {
+		// the input and the normalized boards side by side, with an arrow at the middle row
+		const Zone7x7Bitboard::Layout layout = { true, true, 2, "     ", " >>> " };
+		chunk.text.resize(chunk.output.size() * Zone7x7Bitboard::render_size(2, layout));
+		char* out = &chunk.text[0];
+		for (size_t i = 0; i < chunk.output.size(); i++) {
+			const Zone7x7Bitboard pair[] = { chunk.input[i], chunk.output[i] };
+			out = Zone7x7Bitboard::render(out, pair, 2, layout);
+		}
+		chunk.text.resize(out - chunk.text.data());
+	} else {
+		chunk.text.resize(chunk.output.size() * 64);
+		char* out = &chunk.text[0];
+		for (const Zone7x7Bitboard& z : chunk.output) {
+			out = opts.binary ? encode_record(out, z) : format_board(out, z);
+		}
+		chunk.text.resize(out - chunk.text.data());
+	}
+}
+
+int main(int argc, const char* argv[]) {
+	Options opts;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+			opts.output = argv[++i];
+		} else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+			opts.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "-s" || arg == "--slide") {
+			opts.slide = true;
+		} else if (arg == "-d" || arg == "--dedup") {
+			opts.dedup = true;
+		} else if (arg == "-b" || arg == "--binary") {
+			opts.binary = true;
+		} else if (arg == "-r" || arg == "--render") {
+			opts.render = true;
+		} else if (arg == "--self-test") {
+			size_t errors = Zone7x7BitboardBackends::verify(1000000, 0, std::cerr);
+			std::cout << "backend: " << Zone7x7BitboardBackends::dispatch().name << ", ";
+			std::cout << (errors ? std::to_string(errors) + " mismatches" : "all backends agree") << std::endl;
+			return errors ? 1 : 0;
+#if defined(ZONE7X7_STATS)
+		} else if (arg == "--stats") {
+			opts.stats = true;
+#endif
+		} else if (arg == "-h" || arg == "--help") {
+			std::cout << usage;
+			return 0;
+		} else if (arg.size() > 1 && arg[0] == '-') {
+			std::cerr << "bitboard-normalizer: invalid option '" << arg << "'" << std::endl << usage;
+			return 1;
+		} else {
+			opts.inputs.push_back(arg);
+		}
+	}
+	if (opts.inputs.empty()) opts.inputs.push_back("-");
+
+	FILE* out = (opts.output == "-") ? stdout : std::fopen(opts.output.c_str(), "wb");
+	if (!out) {
+		std::cerr << "bitboard-normalizer: " << opts.output << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	static std::vector<char> outbuf(1 << 20);
+	std::setvbuf(out, outbuf.data(), _IOFBF, outbuf.size());
+
+	const size_t chunk_size = 1 << 20;
+	const size_t window = opts.threads * 4; // chunks processed per round
+	std::unordered_set<Zone7x7Bitboard> seen;
+	std::vector<Chunk> chunks(window);
+
+	for (const std::string& path : opts.inputs) {
+		MappedFile file(path);
+		if (!file.good()) {
+			std::cerr << "bitboard-normalizer: " << file.error() << std::endl;
+			return 1;
+		}
+		for (const char* p = file.begin(); p != file.end(); ) {
+			// split the next window into chunks of complete lines
+			size_t n = 0;
+			for (; n < window && p != file.end(); n++) {
+				const char* end = p + std::min<size_t>(chunk_size, file.end() - p);
+				const char* eol = static_cast<const char*>(std::memchr(end, '\n', file.end() - end));
+				end = eol ? eol + 1 : file.end();
+				chunks[n].begin = p;
+				chunks[n].end = end;
+				p = end;
+			}
+
+			parallel_for(n, opts.threads, [&](size_t i) { parse(chunks[i], opts); });
+			for (size_t i = 0; i < n; i++) {
+				if (chunks[i].error) {
+					size_t line = std::count(file.begin(), chunks[i].error, '\n') + 1;
+					std::cerr << "bitboard-normalizer: " << path << ":" << line << ": invalid board" << std::endl;
+					return 1;
+				}
+			}
+			if (opts.dedup) {
+				for (size_t i = 0; i < n; i++) {
+					size_t m = 0;
+					for (size_t k = 0; k < chunks[i].output.size(); k++) {
+						if (!seen.insert(chunks[i].output[k]).second) continue;
+						chunks[i].input[m] = chunks[i].input[k];
+						chunks[i].output[m] = chunks[i].output[k];
+						m++;
+					}
+					chunks[i].input.resize(m);
+					chunks[i].output.resize(m);
+				}
+			}
+			parallel_for(n, opts.threads, [&](size_t i) { format(chunks[i], opts); });
+			for (size_t i = 0; i < n; i++) {
+				std::fwrite(chunks[i].text.data(), 1, chunks[i].text.size(), out);
+			}
+		}
+	}
+
+	if (std::fflush(out) != 0 || (out != stdout && std::fclose(out) != 0)) {
+		std::cerr << "bitboard-normalizer: " << opts.output << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+#if defined(ZONE7X7_STATS)
+	if (opts.stats) Zone7x7BitboardStats::dump(std::cerr);
+#endif
+	return 0;
+}
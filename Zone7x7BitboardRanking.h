@@ -0,0 +1,201 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * a dense ranking of the boards with a given zone, i.e., a perfect hash from boards to [0, size())
+ *
+ * a coloring of the k zone locations is first ranked as a base-3 number, where the ith digit is
+ * the ith location of the zone (from the lowest bit), which is 0 for empty, 1 for black, and 2 for white.
+ * the base-3 number is computed from pext(black, zone) and pext(white, zone) with 8-bit chunk tables.
+ *
+ * the isomorphisms that map the zone onto itself (i.e., the symmetry of the zone, optionally after slide()) are folded,
+ * so that all symmetric colorings share the same index, and illegal colorings can be excluded.
+ * the remaining base-3 numbers are marked in a bit vector, whose prefix counts give the dense index.
+ * note that the bit vector takes 3^k bits, so k should be at most MAX_CELLS.
+ *
+ * to index boards of all isomorphic zones, normalize() the boards and rank them with the normalized zone
+ */
+class Zone7x7BitboardRanking {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+
+	static constexpr u32 MAX_CELLS = 20;
+	static constexpr u64 npos = ~0ull;
+
+	struct Tables {
+		u64 ternary[256]; // the base-3 number of 8 bits, where each bit is a digit of 0 or 1
+		u64 power[8];     // 3^0, 3^8, 3^16, ..., 3^56 (overflowed entries are unused)
+	};
+	static inline constexpr Tables generate() {
+		Tables t = {};
+		for (u32 x = 0; x < 256; x++) {
+			for (u64 i = 0, p = 1; i < 8; i++, p *= 3) t.ternary[x] += (x & (1u << i)) ? p : 0;
+		}
+		for (u64 i = 0, p = 1; i < 8; i++, p *= 6561) t.power[i] = p;
+		return t;
+	}
+	template<typename = void> struct Static { static constexpr Tables tables = generate(); };
+
+	/**
+	 * compute the base-3 number of the given black and white bits (at most 40 bits)
+	 */
+	static inline u64 ternary(u64 black, u64 white) {
+		const Tables& t = Static<>::tables;
+		u64 x = 0;
+		for (u32 i = 0; black | white; i++, black >>= 8, white >>= 8) {
+			x += (t.ternary[black & 255] + 2 * t.ternary[white & 255]) * t.power[i];
+		}
+		return x;
+	}
+	/**
+	 * split a base-3 number of k digits into black and white bits
+	 */
+	static inline void unternary(u64 x, u32 k, u64& black, u64& white) {
+		black = white = 0;
+		for (u32 i = 0; i < k; i++, x /= 3) {
+			u32 digit = x % 3;
+			black |= u64(digit == 1) << i;
+			white |= u64(digit == 2) << i;
+		}
+	}
+	/**
+	 * increase the base-3 number of the given black and white bits by one,
+	 * i.e., the trailing 2s (white) become 0s, and the next digit becomes 1 (black) from 0, or 2 from 1
+	 */
+	static inline void increase(u64& black, u64& white) {
+		u64 low = (white + 1) & ~white;
+		white &= ~(low - 1);
+		if (black & low) black ^= low, white |= low;
+		else black |= low;
+	}
+
+public:
+	/**
+	 * build the ranking of the given zone
+	 * @param
+	 *  zone        the bitmap of R-zone, with at most MAX_CELLS locations
+	 *  legal_only  set as true to exclude colorings with blocks without liberties, see Zone7x7Bitboard::valid()
+	 *  allow_slide set as true to also fold the isomorphisms that map the zone onto itself after slide(),
+	 *              which should match the boards being normalize(true)d
+	 */
+	inline Zone7x7BitboardRanking(u64 zone, bool legal_only = true, bool allow_slide = false) : mask(zone), cells(__builtin_popcountll(zone)), count(0) {
+		if (cells > MAX_CELLS) throw std::length_error("zone too large for ranking");
+		for (u32 i = 1; i < 8; i++) {
+			u64 x = Zone7x7Bitboard::Isomorphisms::transform(zone, i);
+			Zone7x7Bitboard slid(x, 0, 0);
+			if (allow_slide) slid.slide();
+			u32 shift = x ? __builtin_ctzll(x) - __builtin_ctzll(slid.zone) : 0;
+			if ((x >> shift) == zone) symmetry.push_back({ i, shift });
+		}
+		u64 total = 1;
+		for (u32 i = 0; i < cells; i++) total *= 3;
+		if (symmetry.empty() && !legal_only) {
+			count = total; // every base-3 number is an index
+			return;
+		}
+
+		bits.assign((total + 63) / 64, 0);
+		u64 black = 0, white = 0; // the pext bits of the current base-3 number
+		for (u64 x = 0; x < total; x++) {
+			if (canonical(black, white) == x && (!legal_only || legal(black, white))) bits[x / 64] |= 1ull << (x % 64);
+			increase(black, white);
+		}
+		blocks.resize(bits.size() / 8 + 1);
+		for (size_t i = 0; i < bits.size(); i++) {
+			if (i % 8 == 0) blocks[i / 8] = count;
+			count += __builtin_popcountll(bits[i]);
+		}
+		blocks.back() = (bits.size() % 8 == 0) ? count : blocks.back();
+	}
+
+	/**
+	 * @return the zone of this ranking
+	 */
+	inline u64 zone() const { return mask; }
+	/**
+	 * @return the number of indices, i.e., the number of distinct (legal) colorings up to symmetry
+	 */
+	inline u64 size() const { return count; }
+
+	/**
+	 * rank the given board
+	 * @param
+	 *  z the board, whose zone should be the same as zone()
+	 * @return
+	 *  the index in [0, size()), or npos if the board has another zone or is excluded
+	 */
+	inline u64 rank(const Zone7x7Bitboard& z) const {
+		if (z.zone != mask || ((z.black | z.white) & ~mask) || (z.black & z.white)) return npos;
+		u64 x = canonical(Zone7x7Bitboard::pext(z.black, mask), Zone7x7Bitboard::pext(z.white, mask));
+		if (bits.empty()) return x;
+		if (!(bits[x / 64] & (1ull << (x % 64)))) return npos;
+		u64 r = blocks[x / 512];
+		for (size_t i = (x / 512) * 8; i < x / 64; i++) r += __builtin_popcountll(bits[i]);
+		return r + __builtin_popcountll(bits[x / 64] & ((1ull << (x % 64)) - 1));
+	}
+	/**
+	 * unrank the given index
+	 * @param
+	 *  index the index in [0, size())
+	 * @return
+	 *  the representative board of the index, which is the coloring with the smallest base-3 number
+	 */
+	inline Zone7x7Bitboard unrank(u64 index) const {
+		u64 x = index;
+		if (!bits.empty()) {
+			size_t b = std::upper_bound(blocks.begin(), blocks.end(), index) - blocks.begin() - 1;
+			u64 r = index - blocks[b];
+			size_t i = b * 8;
+			for (u32 n; r >= (n = __builtin_popcountll(bits[i])); i++) r -= n;
+			x = i * 64 + __builtin_ctzll(Zone7x7Bitboard::pdep(1ull << r, bits[i]));
+		}
+		u64 black, white;
+		unternary(x, cells, black, white);
+		return { mask, Zone7x7Bitboard::pdep(black, mask), Zone7x7Bitboard::pdep(white, mask) };
+	}
+
+protected:
+	/**
+	 * @return the smallest base-3 number among the symmetric colorings
+	 */
+	inline u64 canonical(u64 black, u64 white) const {
+		u64 x = ternary(black, white);
+		if (symmetry.empty()) return x;
+		u64 b = Zone7x7Bitboard::pdep(black, mask), w = Zone7x7Bitboard::pdep(white, mask);
+		for (Symmetry s : symmetry) {
+			u64 ib = Zone7x7Bitboard::pext(Zone7x7Bitboard::Isomorphisms::transform(b, s.id) >> s.shift, mask);
+			u64 iw = Zone7x7Bitboard::pext(Zone7x7Bitboard::Isomorphisms::transform(w, s.id) >> s.shift, mask);
+			x = std::min(x, ternary(ib, iw));
+		}
+		return x;
+	}
+	/**
+	 * @return whether all blocks have liberties, see Zone7x7Bitboard::valid()
+	 */
+	inline bool legal(u64 black, u64 white) const {
+		return Zone7x7Bitboard(mask, Zone7x7Bitboard::pdep(black, mask), Zone7x7Bitboard::pdep(white, mask)).valid();
+	}
+
+protected:
+	struct Symmetry {
+		u32 id;    // the isomorphic id number
+		u32 shift; // the shift of slide() after the isomorphism
+	};
+
+	u64 mask;
+	u32 cells;
+	u64 count;
+	std::vector<Symmetry> symmetry;
+	std::vector<u64> bits;   // bit x is set if base-3 number x is an index
+	std::vector<u64> blocks; // the number of indices before every 512 bits
+};
+
+template<typename T>
+constexpr Zone7x7BitboardRanking::Tables Zone7x7BitboardRanking::Static<T>::tables;
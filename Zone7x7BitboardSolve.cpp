@@ -0,0 +1,178 @@
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardSolver.h"
+#include "Zone7x7BitboardIO.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <sys/stat.h>
+
+using u64 = Zone7x7Bitboard::u64;
+using u32 = Zone7x7Bitboard::u32;
+using PieceType = Zone7x7Bitboard::PieceType;
+using namespace Zone7x7BitboardIO;
+
+static const char* usage =
+	"Usage: bitboard-solve [OPTION]... [FILE|DIR]...\n"
+	"Solve the life-and-death problems of the boards (one \"zone black white\" per line) of FILEs,\n"
+	"of the files in DIRs and all their subdirectories (e.g., examples/), or of the standard input.\n"
+	"The attacker wins by capturing the target stone, and the defender wins if the target is unconditionally\n"
+	"alive, if the attacker has no legal move, or if a position repeats. Only the defender may pass.\n"
+	"\n"
+	"  -d, --defender COLOR  black, white, or auto (the color with more stones), default is auto\n"
+	"  -t, --target POINT    the target stone (e.g., C3), default is a stone of the largest defender block\n"
+	"  -f, --first SIDE      the side to move first, attacker or defender, default is attacker\n"
+	"  -n, --nodes N         give up a board after N expanded nodes, 0 for no limit, default is 10000000\n"
+	"  -m, --memory MB       the memory of the transposition table in megabytes, default is 256\n"
+	"  -j, --threads N       use N threads, default is the number of CPUs\n"
+	"  -h, --help            display this help and exit\n"
+	"\n"
+	"Each board is reported as \"zone black white<TAB>result<TAB>move<TAB>nodes<TAB>nodes/sec\", where result is\n"
+	"attacker, defender, or unknown, and move is a winning move of the first side (a point, pass, or -).\n";
+
+struct Options {
+	std::vector<std::string> inputs;
+	std::string defender = "auto";
+	std::string target;
+	bool defender_first = false;
+	u64 nodes = 10000000;
+	size_t memory = 256;
+	u32 threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+/**
+ * parse a point such as "C3" into a location index
+ * @return
+ *  the location index, or 49 if invalid
+ */
+static u32 parse_point(const std::string& text) {
+	if (text.size() != 2) return 49;
+	u32 x = u32((text[0] | 0x20) - 'a'), y = u32(text[1] - '1');
+	return (x < 7 && y < 7) ? y * 7 + x : 49;
+}
+static std::string format_point(u32 i) {
+	if (i == Zone7x7BitboardSolver::PASS) return "pass";
+	if (i >= 49) return "-";
+	return std::string(1, char('A' + i % 7)) + char('1' + i / 7);
+}
+
+/**
+ * make the problem of a board, see the usage
+ * @return
+ *  whether the board has a target stone
+ */
+static bool make_problem(const Zone7x7Bitboard& z, const Options& opts, Zone7x7BitboardSolver::Problem& problem) {
+	u64 black = z.black & z.zone, white = z.white & z.zone;
+	bool is_white = (opts.defender == "white") || (opts.defender == "auto" && __builtin_popcountll(white) > __builtin_popcountll(black));
+	u64 own = is_white ? white : black;
+	u32 target = opts.target.empty() ? 49 : parse_point(opts.target);
+	if (opts.target.empty()) {
+		u32 size = 0;
+		for (u64 rest = own; rest; ) {
+			u64 block = Zone7x7Bitboard::block(rest & -rest, own);
+			if (u32(__builtin_popcountll(block)) > size) size = __builtin_popcountll(block), target = __builtin_ctzll(block);
+			rest &= ~block;
+		}
+	}
+	if (target >= 49 || !(own & (1ull << target))) return false;
+	problem = { Zone7x7Bitboard(z.zone, black, white), target, opts.defender_first, 0 };
+	return true;
+}
+
+/**
+ * append the files of a directory and of all its subdirectories recursively, in sorted order
+ */
+static void collect_files(const std::string& dir, std::vector<std::string>& files) {
+	std::vector<std::string> list = list_directory(dir, false);
+	files.insert(files.end(), list.begin(), list.end());
+	for (const std::string& sub : list_directory(dir, true)) collect_files(sub, files);
+}
+
+int main(int argc, const char* argv[]) {
+	Options opts;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "-d" || arg == "--defender") && i + 1 < argc) {
+			opts.defender = argv[++i];
+			if (opts.defender != "black" && opts.defender != "white" && opts.defender != "auto") {
+				std::cerr << "bitboard-solve: invalid defender '" << opts.defender << "'" << std::endl;
+				return 1;
+			}
+		} else if ((arg == "-t" || arg == "--target") && i + 1 < argc) {
+			opts.target = argv[++i];
+			if (parse_point(opts.target) >= 49) {
+				std::cerr << "bitboard-solve: invalid target '" << opts.target << "'" << std::endl;
+				return 1;
+			}
+		} else if ((arg == "-f" || arg == "--first") && i + 1 < argc) {
+			std::string side = argv[++i];
+			if (side != "attacker" && side != "defender") {
+				std::cerr << "bitboard-solve: invalid side '" << side << "'" << std::endl;
+				return 1;
+			}
+			opts.defender_first = (side == "defender");
+		} else if ((arg == "-n" || arg == "--nodes") && i + 1 < argc) {
+			opts.nodes = std::strtoull(argv[++i], nullptr, 10);
+		} else if ((arg == "-m" || arg == "--memory") && i + 1 < argc) {
+			opts.memory = std::max(1, std::atoi(argv[++i]));
+		} else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+			opts.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "-h" || arg == "--help") {
+			std::cout << usage;
+			return 0;
+		} else if (arg.size() > 1 && arg[0] == '-') {
+			std::cerr << "bitboard-solve: invalid option '" << arg << "'" << std::endl << usage;
+			return 1;
+		} else {
+			opts.inputs.push_back(arg);
+		}
+	}
+	if (opts.inputs.empty()) opts.inputs.push_back("-");
+
+	std::vector<std::string> files;
+	for (const std::string& path : opts.inputs) {
+		struct stat st;
+		if (path == "-" || ::stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+			files.push_back(path);
+		} else {
+			collect_files(path, files);
+		}
+	}
+
+	Zone7x7BitboardSolver solver(opts.memory << 20, opts.threads, opts.nodes);
+	u64 count[3] = {}, nodes = 0;
+	double seconds = 0;
+	for (const std::string& path : files) {
+		MappedFile file(path);
+		if (!file.good()) {
+			std::cerr << "bitboard-solve: " << file.error() << std::endl;
+			return 1;
+		}
+		size_t line = 1;
+		for (const char* p = file.begin(); p != file.end(); line++) {
+			Zone7x7Bitboard z;
+			int n = parse_board(p, file.end(), z);
+			if (n < 0) {
+				std::cerr << "bitboard-solve: " << path << ":" << line << ": invalid board" << std::endl;
+				return 1;
+			}
+			Zone7x7BitboardSolver::Problem problem;
+			if (n == 0) continue;
+			if (!make_problem(z, opts, problem)) {
+				std::cerr << "bitboard-solve: " << path << ":" << line << ": no target stone" << std::endl;
+				continue;
+			}
+			Zone7x7BitboardSolver::Report report = solver.solve(problem);
+			const char* result[] = { "unknown", "attacker", "defender" };
+			std::printf("%llu %llu %llu\t%s\t%s\t%llu\t%.0f\n", z.zone, z.black, z.white, result[report.result],
+				format_point(report.move).c_str(), report.nodes, report.seconds > 0 ? report.nodes / report.seconds : 0.0);
+			count[report.result]++;
+			nodes += report.nodes;
+			seconds += report.seconds;
+		}
+	}
+	std::fflush(stdout);
+	std::cerr << "bitboard-solve: " << count[1] + count[2] + count[0] << " boards, " << count[1] << " attacker, ";
+	std::cerr << count[2] << " defender, " << count[0] << " unknown, " << nodes << " nodes, ";
+	std::cerr << u64(seconds > 0 ? nodes / seconds : 0) << " nodes/sec" << std::endl;
+	return 0;
+}
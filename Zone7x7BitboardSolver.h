@@ -0,0 +1,395 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7TranspositionTable.h"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <algorithm>
+
+/**
+ * a parallel depth-first proof-number (df-pn) solver of life-and-death problems in R-zones
+ *
+ * a problem is a board, a target stone of the defender, and the side to move, where the rules are restricted to
+ * the zone (see Zone7x7Bitboard::empty()), i.e., moves are only played at the zone, and irrelevant locations are walls.
+ * the attacker wins by capturing the target stone, while the defender wins when the target stone is unconditionally
+ * alive (see alive()), when the attacker has no legal move, or when a position repeats; the defender may pass,
+ * but the attacker may not.
+ *
+ * the search is df-pn (Nagai 2002) from the point of view of the attacker, whose nodes are OR nodes.
+ * each child is normalized with slide() so that isomorphic nodes are merged (the ko and the target are transformed
+ * as well), and the proof and disproof numbers are shared by a Zone7x7TranspositionTable, whose key packs the ko,
+ * the target, and the side to move into the unused high bits of zone. all threads search the same root (lazy SMP),
+ * each prefers a different child among ties, and they stop as soon as one of them solves the root.
+ * a solved result that depends on a repetition of an ancestor (i.e., on the path to it) is never stored in the table,
+ * but is cached by the thread only while that ancestor is in the path, see mid(); the other results are assumed
+ * to be independent of the path, i.e., the graph history interaction is only handled for repetitions.
+ */
+class Zone7x7BitboardSolver {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+	using PieceType = Zone7x7Bitboard::PieceType;
+
+	enum Result {
+		UNKNOWN = 0,       // the node limit is reached
+		ATTACKER_WINS = 1, // the target stone is captured
+		DEFENDER_WINS = 2, // the target stone lives
+	};
+	static constexpr u32 PASS = 49; // the move index of passing
+	static constexpr u32 NONE = 64; // no move
+
+	/**
+	 * a life-and-death problem
+	 */
+	struct Problem {
+		Zone7x7Bitboard board;
+		u32 target;          // the location (y * 7 + x) of a defender stone, whose color is the defender
+		bool defender_first; // whether the defender moves first, otherwise the attacker does
+		u64 ko;              // the location forbidden by the ko rule, see Zone7x7Bitboard::play()
+	};
+	/**
+	 * the result of solve()
+	 */
+	struct Report {
+		Result result;
+		u32 move;       // a winning move (location or PASS) of the first player, or NONE if it loses or is unknown
+		u64 nodes;      // the number of expanded nodes of all threads
+		double seconds; // the elapsed time
+	};
+
+public:
+	/**
+	 * @param
+	 *  bytes     the memory of the transposition table, see Zone7x7TranspositionTable
+	 *  threads   the number of threads
+	 *  max_nodes the maximum expanded nodes of a problem, or 0 for no limit
+	 */
+	inline Zone7x7BitboardSolver(size_t bytes = size_t(256) << 20, u32 threads = 1, u64 max_nodes = 0)
+		: table(bytes), threads(std::max(threads, 1u)), max_nodes(max_nodes) {}
+
+	/**
+	 * solve the given problem, the transposition table is kept for later problems
+	 */
+	inline Report solve(const Problem& problem) {
+		const auto start = std::chrono::steady_clock::now();
+		table.new_generation();
+		Shared shared(problem);
+		Node root = { problem.board, problem.ko, problem.target, problem.defender_first };
+
+		Bound result = evaluate(shared, root);
+		if (result.pn && result.dn) {
+			auto work = [&](u32 id) {
+				Search s(shared, id);
+				while (!shared.stop.load(std::memory_order_relaxed)) {
+					u32 dependency;
+					Bound b = mid(s, root, INF, INF, dependency);
+					if (!b.pn || !b.dn) {
+						if (!shared.stop.exchange(true)) shared.result = b, shared.move = s.move;
+						break;
+					}
+				}
+				shared.nodes += s.nodes - s.reported;
+			};
+			std::vector<std::thread> workers;
+			for (u32 id = 1; id < threads; id++) workers.emplace_back(work, id);
+			work(0);
+			for (std::thread& worker : workers) worker.join();
+			result = shared.result;
+		}
+
+		Report report = { UNKNOWN, NONE, shared.nodes.load(), 0 };
+		report.result = !result.pn ? ATTACKER_WINS : !result.dn ? DEFENDER_WINS : UNKNOWN;
+		if (report.result != UNKNOWN && (report.result == DEFENDER_WINS) == root.defender) report.move = shared.move;
+		report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return report;
+	}
+
+	/**
+	 * find the unconditionally alive stones by Benson's algorithm, where the zone is the whole board
+	 * i.e., a set of blocks is alive if each block has at least 2 vital regions, where a region is a maximal connected
+	 * set of non-own locations in the zone enclosed by the set, and is vital to a block if all its empty locations
+	 * are liberties of the block
+	 * @param
+	 *  z     the board
+	 *  color the color of stones, either ZONE_BLACK or ZONE_WHITE
+	 * @return
+	 *  the bitmap of alive stones
+	 */
+	static inline u64 alive(const Zone7x7Bitboard& z, u32 color) {
+		const u64 own = (color == PieceType::ZONE_WHITE ? z.white : z.black) & z.zone;
+		const u64 space = z.zone & ~own, empty = z.empty();
+		u64 block[32], region[32];
+		u32 nb = 0, nr = 0;
+		for (u64 rest = own; rest; rest &= ~block[nb++]) block[nb] = Zone7x7Bitboard::block(rest & -rest, own);
+		for (u64 rest = space; rest; rest &= ~region[nr++]) region[nr] = Zone7x7Bitboard::block(rest & -rest, space);
+
+		u32 vital[32] = {}; // the vital regions of each block
+		for (u32 b = 0; b < nb; b++) {
+			const u64 liberties = Zone7x7Bitboard::neighbors(block[b]) & empty;
+			for (u32 r = 0; r < nr; r++) {
+				u64 points = region[r] & empty;
+				if (points && !(points & ~liberties)) vital[b] |= 1u << r;
+			}
+		}
+		u32 blocks = nb < 32 ? (1u << nb) - 1 : ~0u, regions = nr < 32 ? (1u << nr) - 1 : ~0u;
+		for (bool changed = true; changed; ) {
+			changed = false;
+			u64 stones = 0;
+			for (u32 b = 0; b < nb; b++) {
+				if (!(blocks & (1u << b))) continue;
+				if (__builtin_popcount(vital[b] & regions) < 2) {
+					blocks &= ~(1u << b);
+					changed = true;
+				} else {
+					stones |= block[b];
+				}
+			}
+			for (u32 r = 0; r < nr; r++) {
+				if (!(regions & (1u << r))) continue;
+				if (Zone7x7Bitboard::neighbors(region[r]) & own & ~stones) regions &= ~(1u << r); // next to a removed block
+			}
+			if (!changed) return stones;
+		}
+		return 0;
+	}
+
+protected:
+	static constexpr u32 INF = 0xffffu; // proof and disproof numbers are 16 bits, saturated at INF - 1
+
+	struct Bound {
+		u32 pn; // proof number of the attacker
+		u32 dn; // disproof number of the attacker
+	};
+	static inline u32 sum(u32 a, u32 b) { return (a == INF || b == INF) ? INF : std::min(a + b, INF - 1); }
+
+	/**
+	 * a position of the search
+	 */
+	struct Node {
+		Zone7x7Bitboard board;
+		u64 ko;
+		u32 target;
+		bool defender; // whether the defender is to move
+
+		/**
+		 * the key of the transposition table, bits 49-54 are the ko location + 1 (or 0 for no ko),
+		 * bits 55-60 are the target location, and bit 61 is the side to move
+		 */
+		inline Zone7x7Bitboard key() const {
+			u64 k = ko ? __builtin_ctzll(ko) + 1 : 0;
+			return { board.zone | (k << 49) | (u64(target) << 55) | (u64(defender) << 61), board.black, board.white };
+		}
+		/**
+		 * normalize the board with slide(), and transform the ko and the target accordingly
+		 */
+		inline void normalize() {
+			Zone7x7Bitboard::Transformation t = board.canonicalize(true);
+			ko = t.apply(ko);
+			target = Zone7x7Bitboard::Isomorphisms::map(target, t.iso) - t.shift;
+		}
+	};
+	struct Child {
+		Node node;
+		Zone7x7Bitboard key;
+		u32 move;
+		bool terminal;
+		Bound bound; // the bound of a terminal child
+	};
+	/**
+	 * a solved result that depends on the path, which is valid while its ancestor at the given depth is in the path
+	 */
+	struct Local {
+		Bound bound;
+		u32 depth;
+	};
+
+	/**
+	 * the state shared by all threads of a problem
+	 */
+	struct Shared {
+		u32 defender;
+		u32 attacker;
+		std::atomic<bool> stop;
+		std::atomic<u64> nodes;
+		Bound result;
+		u32 move; // the winning move of the root, or NONE
+
+		inline Shared(const Problem& problem) : stop(false), nodes(0), result{ 1, 1 }, move(NONE) {
+			defender = (problem.board.white >> problem.target) & 1 ? PieceType::ZONE_WHITE : PieceType::ZONE_BLACK;
+			attacker = defender ^ (PieceType::ZONE_BLACK | PieceType::ZONE_WHITE);
+		}
+	};
+	/**
+	 * the state of a thread
+	 */
+	struct Search {
+		Shared& shared;
+		u32 id;
+		u64 nodes;
+		u64 reported; // the nodes added to shared.nodes
+		std::unordered_map<Zone7x7Bitboard, u32> path; // the depth (1 for the root) of each node in the path
+		std::vector<Child> children; // a stack of the children of the nodes in the path
+		std::unordered_map<Zone7x7Bitboard, Local> local; // the results that depend on the path
+		std::vector<std::vector<Zone7x7Bitboard>> expiry; // the keys of local results by their depths
+		u32 move; // the winning move of the root, see mid()
+
+		inline Search(Shared& shared, u32 id) : shared(shared), id(id), nodes(0), reported(0), move(NONE) {}
+	};
+
+	/**
+	 * evaluate a node without searching
+	 * @return
+	 *  the bound of a terminal node, or (1, 1) for an unknown one
+	 */
+	static inline Bound evaluate(const Shared& shared, const Node& n) {
+		const u64 target = 1ull << n.target;
+		const u64 own = shared.defender == PieceType::ZONE_WHITE ? n.board.white : n.board.black;
+		if (!(own & target)) return { 0, INF };
+		if (alive(n.board, shared.defender) & target) return { INF, 0 };
+		if (!n.defender && !n.board.legal_moves(shared.attacker, n.ko)) return { INF, 0 };
+		return { 1, 1 };
+	}
+	/**
+	 * push the children of a node, in the order of moves, then passing
+	 */
+	static inline void expand(Search& s, const Node& n) {
+		const u32 color = n.defender ? s.shared.defender : s.shared.attacker;
+		const size_t first = s.children.size();
+		for (u64 moves = n.board.legal_moves(color, n.ko); moves; moves &= moves - 1) {
+			u32 i = __builtin_ctzll(moves);
+			Child c = { n, {}, i, false, { 1, 1 } };
+			c.node.board.play(i % 7, i / 7, color, c.node.ko);
+			c.node.defender = !n.defender;
+			s.children.push_back(c);
+		}
+		if (n.defender) s.children.push_back({ { n.board, 0, n.target, false }, {}, PASS, false, { 1, 1 } });
+		for (size_t i = first; i < s.children.size(); i++) {
+			Child& c = s.children[i];
+			c.node.normalize();
+			c.key = c.node.key();
+			c.bound = evaluate(s.shared, c.node);
+			c.terminal = !c.bound.pn || !c.bound.dn;
+		}
+	}
+	/**
+	 * @param
+	 *  dependency set as the depth of the deepest ancestor that the bound depends on, or 0 if none
+	 * @return the current bound of a child
+	 */
+	inline Bound bound(const Search& s, const Child& c, u32& dependency) const {
+		dependency = 0;
+		if (c.terminal) return c.bound;
+		auto repetition = s.path.find(c.key);
+		if (repetition != s.path.end()) {
+			dependency = repetition->second;
+			return { INF, 0 };
+		}
+		auto cached = s.local.find(c.key);
+		if (cached != s.local.end()) {
+			dependency = cached->second.depth;
+			return cached->second.bound;
+		}
+		u32 data, depth;
+		if (table.probe(c.key, data, depth)) return { data >> 16, data & 0xffffu };
+		return { 1, 1 };
+	}
+
+	/**
+	 * the multiple iterative deepening of df-pn, which searches until pn >= thpn or dn >= thdn
+	 * a solved result depends on the ancestors that its deciding children depend on, where the deciding children are
+	 * the best one of those that decide the result by themselves (a proof of an OR node or a disproof of an AND node),
+	 * or all children otherwise; a dependency on the node itself is dropped, since any path to the node includes it.
+	 * a result without dependency is stored in the table, otherwise it is cached in s.local until its deepest
+	 * ancestor leaves the path. the winning move of the root is kept in s.move
+	 * @param
+	 *  dependency set as the depth of the deepest ancestor that the returned bound depends on, or 0 if none
+	 * @return
+	 *  the bound of the node
+	 */
+	inline Bound mid(Search& s, const Node& n, u32 thpn, u32 thdn, u32& dependency) {
+		if (++s.nodes - s.reported >= 1024) {
+			u64 total = (s.shared.nodes += s.nodes - s.reported);
+			s.reported = s.nodes;
+			if (max_nodes && total >= max_nodes) s.shared.stop = true;
+		}
+		const Zone7x7Bitboard key = n.key();
+		const u64 before = s.nodes;
+		u32 data, depth = 0;
+		table.probe(key, data, depth);
+
+		const size_t first = s.children.size();
+		expand(s, n);
+		const size_t last = s.children.size(), count = last - first;
+		const u32 level = s.path.size() + 1;
+		s.path.emplace(key, level);
+		if (s.expiry.size() <= level) s.expiry.resize(level + 1);
+
+		Bound b;
+		size_t winner; // a child that decides the result by itself, preferring the least dependent one
+		u32 winner_dependency, max_dependency;
+		for (;;) {
+			// OR nodes (the attacker to move) take the minimal pn, and AND nodes take the minimal dn
+			b = n.defender ? Bound{ 0, INF } : Bound{ INF, 0 };
+			size_t best = last;
+			u32 best_value = INF, second = INF, best_bound = 0;
+			winner = last, winner_dependency = max_dependency = 0;
+			for (size_t k = 0; k < count; k++) {
+				size_t i = first + (k + s.id) % count; // each thread prefers a different child among ties
+				u32 dep;
+				Bound c = bound(s, s.children[i], dep);
+				u32 value = n.defender ? c.dn : c.pn;
+				b = n.defender ? Bound{ sum(b.pn, c.pn), std::min(b.dn, c.dn) } : Bound{ std::min(b.pn, c.pn), sum(b.dn, c.dn) };
+				if (best == last || value < best_value) {
+					second = best == last ? second : best_value;
+					best = i, best_value = value, best_bound = n.defender ? c.pn : c.dn;
+				} else {
+					second = std::min(second, value);
+				}
+				if (!value && (winner == last || dep < winner_dependency)) winner = i, winner_dependency = dep;
+				max_dependency = std::max(max_dependency, dep);
+			}
+			if (b.pn >= thpn || b.dn >= thdn || s.shared.stop.load(std::memory_order_relaxed)) break;
+
+			u32 child_thpn, child_thdn;
+			if (!n.defender) {
+				child_thpn = std::min(thpn, sum(second, 1));
+				child_thdn = std::min<u64>(u64(thdn) - b.dn + best_bound, INF);
+			} else {
+				child_thpn = std::min<u64>(u64(thpn) - b.pn + best_bound, INF);
+				child_thdn = std::min(thdn, sum(second, 1));
+			}
+			const Node child = s.children[best].node;
+			u32 dep;
+			mid(s, child, child_thpn, child_thdn, dep);
+		}
+
+		const bool solved = !b.pn || !b.dn;
+		dependency = !solved ? 0 : winner != last ? winner_dependency : max_dependency;
+		if (dependency >= level) dependency = 0;
+		if (winner != last && level == 1) s.move = s.children[winner].move; // the root
+
+		// drop the local results that depend on this node, which leaves the path
+		for (const Zone7x7Bitboard& k : s.expiry[level]) s.local.erase(k);
+		s.expiry[level].clear();
+		s.path.erase(key);
+		s.children.resize(first);
+		if (dependency) {
+			s.local[key] = { b, dependency };
+			s.expiry[dependency].push_back(key);
+		} else {
+			u64 work = std::min<u64>(depth + (s.nodes - before), Zone7x7TranspositionTable<u32>::MAX_DEPTH);
+			table.store(key, (b.pn << 16) | b.dn, work);
+		}
+		return b;
+	}
+
+protected:
+	Zone7x7TranspositionTable<u32> table;
+	u32 threads;
+	u64 max_nodes;
+};
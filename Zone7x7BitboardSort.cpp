@@ -0,0 +1,118 @@
+#include "Zone7x7Bitboard.h"
+#include "Zone7x7BitboardExternalSort.h"
+#include "Zone7x7BitboardIO.h"
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+using u64 = Zone7x7Bitboard::u64;
+using u32 = Zone7x7Bitboard::u32;
+using namespace Zone7x7BitboardIO;
+
+static const char* usage =
+	"Usage: bitboard-sort [OPTION]... [FILE]...\n"
+	"Normalize, sort, and deduplicate the binary records (zone, black, white as 64-bit little-endian)\n"
+	"of FILEs, or the standard input, with temporary files if they do not fit in memory.\n"
+	"\n"
+	"  -o, --output FILE   write to FILE instead of the standard output\n"
+	"  -s, --slide         invoke slide() for all isomorphisms, i.e., normalize(true)\n"
+	"  -k, --keep          sort and deduplicate the boards as they are, without normalizing\n"
+	"  -m, --memory MB     the memory budget in megabytes, default is 1024\n"
+	"  -T, --temp DIR      the directory of temporary files, default is $TMPDIR or /tmp\n"
+	"  -v, --verbose       print the number of boards and runs to the standard error\n"
+	"  -h, --help          display this help and exit\n"
+	"\n"
+	"The output is in the order of Zone7x7Bitboard::operator<(), with the same record format.\n";
+
+struct Options {
+	std::vector<std::string> inputs;
+	std::string output = "-";
+	bool slide = false;
+	bool keep = false;
+	size_t memory = 1024;
+	std::string temp = std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+	bool verbose = false;
+};
+
+int main(int argc, const char* argv[]) {
+	Options opts;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+			opts.output = argv[++i];
+		} else if (arg == "-s" || arg == "--slide") {
+			opts.slide = true;
+		} else if (arg == "-k" || arg == "--keep") {
+			opts.keep = true;
+		} else if ((arg == "-m" || arg == "--memory") && i + 1 < argc) {
+			opts.memory = std::max(1, std::atoi(argv[++i]));
+		} else if ((arg == "-T" || arg == "--temp") && i + 1 < argc) {
+			opts.temp = argv[++i];
+		} else if (arg == "-v" || arg == "--verbose") {
+			opts.verbose = true;
+		} else if (arg == "-h" || arg == "--help") {
+			std::cout << usage;
+			return 0;
+		} else if (arg.size() > 1 && arg[0] == '-') {
+			std::cerr << "bitboard-sort: invalid option '" << arg << "'" << std::endl << usage;
+			return 1;
+		} else {
+			opts.inputs.push_back(arg);
+		}
+	}
+	if (opts.inputs.empty()) opts.inputs.push_back("-");
+
+	Zone7x7BitboardExternalSort sorter(opts.memory << 20, opts.temp, !opts.keep, opts.slide);
+	const size_t block = RECORD_SIZE << 16;
+	for (const std::string& path : opts.inputs) {
+		int fd = (path == "-") ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			std::cerr << "bitboard-sort: " << path << ": " << std::strerror(errno) << std::endl;
+			return 1;
+		}
+		Zone7x7BitboardExternalSort::BlockReader reader(fd, block);
+		const char* data;
+		size_t keep = 0;
+		for (size_t n; (n = reader.next(data, keep)) != 0 && sorter.good(); ) {
+			size_t records = (keep + n) / RECORD_SIZE;
+			sorter.push_records(data, records);
+			keep = (keep + n) % RECORD_SIZE;
+		}
+		if (reader.error() || keep) {
+			const char* error = reader.error() ? std::strerror(reader.error()) : "truncated record";
+			std::cerr << "bitboard-sort: " << path << ": " << error << std::endl;
+			return 1;
+		}
+		if (fd != STDIN_FILENO) ::close(fd);
+	}
+
+	int fd = (opts.output == "-") ? STDOUT_FILENO : ::open(opts.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		std::cerr << "bitboard-sort: " << opts.output << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	Zone7x7BitboardExternalSort::BlockWriter writer(fd, block);
+	const size_t runs = sorter.spilled();
+	u64 count = sorter.merge([&](const Zone7x7Bitboard& z) {
+		writer.commit(encode_record(writer.reserve(RECORD_SIZE), z));
+	});
+	if (!sorter.good()) {
+		std::cerr << "bitboard-sort: " << sorter.error() << std::endl;
+		return 1;
+	}
+	if (int error = writer.finish()) {
+		std::cerr << "bitboard-sort: " << opts.output << ": " << std::strerror(error) << std::endl;
+		return 1;
+	}
+	if (fd != STDOUT_FILENO && ::close(fd) != 0) {
+		std::cerr << "bitboard-sort: " << opts.output << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	if (opts.verbose) {
+		std::cerr << "bitboard-sort: " << sorter.size() << " boards, " << count << " distinct, ";
+		std::cerr << runs << " runs spilled" << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+/**
+ * optional counters of normalization and symmetry statistics, which are compiled only if ZONE7X7_STATS is defined,
+ * e.g., g++ -DZONE7X7_STATS ..., so that a build without it has no counting code at all
+ *
+ * each thread owns a block of counters aligned to cache lines, which is registered globally at its first use,
+ * and is updated only by its owner with relaxed loads and stores, i.e., no locked instruction and no shared write.
+ * collect() merges the blocks of the live threads and the totals of the exited threads on demand,
+ * and dump() prints the merged counters as JSON.
+ */
+class Zone7x7BitboardStats {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = unsigned long long int;
+	using u32 = unsigned int;
+
+	/**
+	 * the counters, some of them are histograms of consecutive counters
+	 */
+	enum Counter : u32 {
+		NORMALIZE = 0,        // normalize() or canonicalize() without slide
+		NORMALIZE_SLIDE = 1,  // normalize() or canonicalize() with slide
+		ISO = 2,              // [8] the isomorphic id number of the result
+		SYMMETRY = 10,        // [4] the zone has 1, 2, 4, or 8 minimal isomorphisms
+		SELF_SYMMETRIC = 14,  // the board is equal to another isomorphism of itself
+		SHIFT_ROWS = 15,      // [7] the rows shifted by slide() of the result, with slide
+		SHIFT_COLUMNS = 22,   // [7] the columns shifted by slide() of the result, with slide
+		SLIDE = 29,           // slide() invoked directly
+		SLIDE_SHIFTED = 30,   // slide() invoked directly and the board is moved
+		COUNT = 31,
+	};
+
+	/**
+	 * the merged counters
+	 */
+	struct Snapshot {
+		u64 value[COUNT];
+		u32 threads; // the number of threads that have updated counters
+
+		inline u64 operator[](u32 i) const { return value[i]; }
+	};
+
+public:
+	/**
+	 * add n to a counter of the calling thread
+	 */
+	static inline void add(u32 counter, u64 n = 1) {
+		std::atomic<u64>& c = local().value[counter];
+		c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+	/**
+	 * merge the counters of all threads, including the exited ones
+	 * the counters being updated concurrently may or may not be included
+	 */
+	static inline Snapshot collect() {
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		Snapshot s = r.retired;
+		for (const Block* b : r.blocks) {
+			for (u32 i = 0; i < COUNT; i++) s.value[i] += b->value[i].load(std::memory_order_relaxed);
+		}
+		s.threads += r.blocks.size();
+		return s;
+	}
+	/**
+	 * reset the counters of all threads, the counters being updated concurrently may not be reset
+	 */
+	static inline void reset() {
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		r.retired = {};
+		for (Block* b : r.blocks) {
+			for (u32 i = 0; i < COUNT; i++) b->value[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * print the given counters as JSON
+	 * @param
+	 *  out the ostream to print
+	 *  s   the counters, see collect()
+	 * @return
+	 *  the given ostream (out)
+	 */
+	static inline std::ostream& dump(std::ostream& out, const Snapshot& s) {
+		auto array = [&](u32 first, u32 n) -> std::ostream& {
+			out << '[';
+			for (u32 i = 0; i < n; i++) out << (i ? ", " : "") << s[first + i];
+			return out << ']';
+		};
+		out << "{\n";
+		out << "  \"threads\": " << s.threads << ",\n";
+		out << "  \"normalize\": { \"plain\": " << s[NORMALIZE] << ", \"slide\": " << s[NORMALIZE_SLIDE] << " },\n";
+		out << "  \"iso\": ", array(ISO, 8) << ",\n";
+		out << "  \"zone_symmetry\": { \"1\": " << s[SYMMETRY + 0] << ", \"2\": " << s[SYMMETRY + 1];
+		out << ", \"4\": " << s[SYMMETRY + 2] << ", \"8\": " << s[SYMMETRY + 3] << " },\n";
+		out << "  \"self_symmetric\": " << s[SELF_SYMMETRIC] << ",\n";
+		out << "  \"slide_shift\": { \"rows\": ", array(SHIFT_ROWS, 7) << ", \"columns\": ", array(SHIFT_COLUMNS, 7) << " },\n";
+		out << "  \"slide\": { \"calls\": " << s[SLIDE] << ", \"shifted\": " << s[SLIDE_SHIFTED] << " }\n";
+		return out << "}" << std::endl;
+	}
+	/**
+	 * print the current counters of all threads as JSON, see collect()
+	 */
+	static inline std::ostream& dump(std::ostream& out) {
+		return dump(out, collect());
+	}
+
+protected:
+	/**
+	 * the counters of a thread, which is registered on construction,
+	 * and is merged into the retired totals on destruction (i.e., when the thread exits)
+	 */
+	struct alignas(64) Block {
+		std::atomic<u64> value[COUNT];
+
+		inline Block() {
+			for (u32 i = 0; i < COUNT; i++) value[i].store(0, std::memory_order_relaxed);
+			Registry& r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			r.blocks.push_back(this);
+		}
+		inline ~Block() {
+			Registry& r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			for (u32 i = 0; i < COUNT; i++) r.retired.value[i] += value[i].load(std::memory_order_relaxed);
+			r.retired.threads++;
+			r.blocks.erase(std::find(r.blocks.begin(), r.blocks.end(), this));
+		}
+	};
+	struct Registry {
+		std::mutex mutex;
+		std::vector<Block*> blocks;
+		Snapshot retired = {};
+	};
+
+	static inline Registry& registry() {
+		static Registry r;
+		return r;
+	}
+	static inline Block& local() {
+		static thread_local Block b;
+		return b;
+	}
+};
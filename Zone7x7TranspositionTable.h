@@ -0,0 +1,170 @@
+#pragma once
+#include "Zone7x7Bitboard.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+/**
+ * a fixed-size lock-free transposition table keyed on Zone7x7Bitboard
+ *
+ * the table is an array of 64-byte buckets, each bucket holds 2 entries of 32 bytes,
+ * and each entry is 4 words: zone ^ hash ^ data, black ^ data, white ^ data, and data,
+ * where data packs the payload (32 bits), the depth (16 bits), and the generation (8 bits),
+ * and hash is Zone7x7Bitboard::hash() of the whole key.
+ * a torn entry written by concurrent threads decodes into a mismatched key and is simply ignored,
+ * i.e., the lockless hashing scheme by Hyatt and Mann, extended to a 147-bit key.
+ * the hash guards the words of different keys with the same data, which are common (e.g., proofs of the same depth),
+ * since a key mixed from such entries no longer matches the hash of the entry its zone word comes from.
+ *
+ * when an entry should be replaced, the entry of the same board is preferred,
+ * otherwise an empty entry, then an entry of an older generation, and finally the shallowest entry
+ *
+ * @param
+ *  Payload the user payload type, should be trivially copyable and at most 32 bits
+ */
+template<typename Payload = Zone7x7Bitboard::u32>
+class Zone7x7TranspositionTable {
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = Zone7x7Bitboard::u64;
+	using u32 = Zone7x7Bitboard::u32;
+	static_assert(sizeof(Payload) <= sizeof(u32), "payload should be at most 32 bits");
+	static_assert(std::is_trivially_copyable<Payload>::value, "payload should be trivially copyable");
+
+	static constexpr u32 MAX_DEPTH = 0xffffu;
+
+protected:
+	struct Entry {
+		std::atomic<u64> zone;  // zone ^ hash ^ data
+		std::atomic<u64> black; // black ^ data
+		std::atomic<u64> white; // white ^ data
+		std::atomic<u64> data;  // used (1) | generation (8) | depth (16) | payload (32)
+	};
+	struct alignas(64) Bucket {
+		Entry entry[2];
+	};
+
+	static constexpr u64 USED = 1ull << 56;
+	static inline constexpr u32 depth_of(u64 data) { return (data >> 32) & 0xffffu; }
+	static inline constexpr u32 generation_of(u64 data) { return (data >> 48) & 0xffu; }
+
+public:
+	/**
+	 * construct a table with the given capacity
+	 * @param
+	 *  bytes       the memory budget, will be rounded down to a power of 2 (at least one bucket)
+	 *  normalize   set as true to normalize boards on store() and probe(),
+	 *              so that all isomorphic boards share the same entry
+	 *  allow_slide set as true to also invoke slide() when normalizing, see Zone7x7Bitboard::normalize()
+	 */
+	inline Zone7x7TranspositionTable(size_t bytes, bool normalize = false, bool allow_slide = false)
+			: table(nullptr), mask(0), generation(0), normalize(normalize), allow_slide(allow_slide) {
+		size_t n = 1;
+		while (n * 2 * sizeof(Bucket) <= bytes) n *= 2;
+		void* p = nullptr;
+		if (posix_memalign(&p, alignof(Bucket), n * sizeof(Bucket)) != 0) throw std::bad_alloc();
+		table = static_cast<Bucket*>(p);
+		mask = n - 1;
+		clear();
+	}
+	inline ~Zone7x7TranspositionTable() { free(table); }
+	Zone7x7TranspositionTable(const Zone7x7TranspositionTable&) = delete;
+	Zone7x7TranspositionTable& operator =(const Zone7x7TranspositionTable&) = delete;
+
+	/**
+	 * clear all entries, this function is NOT thread-safe
+	 */
+	inline void clear() {
+		std::memset(static_cast<void*>(table), 0, (mask + 1) * sizeof(Bucket));
+		generation.store(0, std::memory_order_relaxed);
+	}
+	/**
+	 * start a new generation (e.g., a new search), entries of older generations are replaced first
+	 */
+	inline void new_generation() { generation.store((generation.load(std::memory_order_relaxed) + 1) & 0xffu, std::memory_order_relaxed); }
+	/**
+	 * @return the number of entries
+	 */
+	inline size_t capacity() const { return (mask + 1) * 2; }
+
+public:
+	/**
+	 * look up the given board
+	 * @param
+	 *  z       the board to be looked up
+	 *  payload the stored payload, only written when the board is found
+	 *  depth   the stored depth, only written when the board is found
+	 * @return
+	 *  whether the board is found
+	 */
+	inline bool probe(Zone7x7Bitboard z, Payload& payload, u32& depth) const {
+		if (normalize) z.normalize(allow_slide);
+		const u64 hash = z.hash();
+		const Bucket& bucket = table[hash & mask];
+		for (const Entry& e : bucket.entry) {
+			u64 data = e.data.load(std::memory_order_relaxed);
+			if (!(data & USED)) continue;
+			if ((e.zone.load(std::memory_order_relaxed) ^ hash ^ data) != z.zone) continue;
+			if ((e.black.load(std::memory_order_relaxed) ^ data) != z.black) continue;
+			if ((e.white.load(std::memory_order_relaxed) ^ data) != z.white) continue;
+			u32 raw = static_cast<u32>(data);
+			std::memcpy(&payload, &raw, sizeof(Payload));
+			depth = depth_of(data);
+			return true;
+		}
+		return false;
+	}
+	/**
+	 * store the given board with its payload
+	 * an existing entry of the same board is kept if it is deeper and of the current generation
+	 * @param
+	 *  z       the board to be stored
+	 *  payload the payload
+	 *  depth   the depth (or any other measure of importance) of the payload, at most MAX_DEPTH
+	 */
+	inline void store(Zone7x7Bitboard z, const Payload& payload, u32 depth) {
+		if (normalize) z.normalize(allow_slide);
+		const u64 hash = z.hash();
+		Bucket& bucket = table[hash & mask];
+		const u32 current = generation.load(std::memory_order_relaxed);
+
+		Entry* victim = nullptr;
+		int score = 0;
+		for (Entry& e : bucket.entry) {
+			u64 data = e.data.load(std::memory_order_relaxed);
+			if (!(data & USED)) {
+				if (!victim || score > -1) victim = &e, score = -1;
+				continue;
+			}
+			bool same = ((e.zone.load(std::memory_order_relaxed) ^ hash ^ data) == z.zone)
+			          & ((e.black.load(std::memory_order_relaxed) ^ data) == z.black)
+			          & ((e.white.load(std::memory_order_relaxed) ^ data) == z.white);
+			if (same) {
+				if (depth < depth_of(data) && generation_of(data) == current) return;
+				victim = &e;
+				break;
+			}
+			int s = int(depth_of(data)) + (generation_of(data) == current ? int(MAX_DEPTH) + 1 : 0);
+			if (!victim || s < score) victim = &e, score = s;
+		}
+
+		u32 raw = 0;
+		std::memcpy(&raw, &payload, sizeof(Payload));
+		u64 data = USED | (u64(current) << 48) | (u64(depth < MAX_DEPTH ? depth : MAX_DEPTH) << 32) | raw;
+		victim->zone.store(z.zone ^ hash ^ data, std::memory_order_relaxed);
+		victim->black.store(z.black ^ data, std::memory_order_relaxed);
+		victim->white.store(z.white ^ data, std::memory_order_relaxed);
+		victim->data.store(data, std::memory_order_relaxed);
+	}
+
+protected:
+	Bucket* table;
+	size_t mask;
+	std::atomic<u32> generation;
+	bool normalize;
+	bool allow_slide;
+};
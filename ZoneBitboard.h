@@ -0,0 +1,783 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+template<unsigned int N> class ZoneBitboard;
+
+/**
+ * the size-independent parts of ZoneBitboard<N> and its specialization Zone7x7Bitboard (ZoneBitboard<7>),
+ * i.e., the common definitions, the rules of Go restricted to the R-zone, the isomorphisms with their group tables,
+ * and canonicalize(), all of which are written against the masks and the primitives of ZoneBitboard<N>:
+ * BOARD_MASK, COL_MASK(), BIT_MASK(), transpose(), flip(), mirror(), and slide_offset()
+ * the bitmaps (zone, black, and white) are members of ZoneBitboard<N>, which derives from this class
+ */
+template<unsigned int N>
+class ZoneBitboardBase {
+	static_assert(N >= 5 && N <= 9, "ZoneBitboard supports 5x5 to 9x9 boards");
+	using Board = ZoneBitboard<N>;
+public:
+	/**
+	 * common definitions
+	 */
+	using u64 = unsigned long long int;
+	using u32 = unsigned int;
+	using word = typename std::conditional<(N * N <= 64), u64, __uint128_t>::type;
+
+	static constexpr u32 SIZE = N;
+
+	/**
+	 * count the set bits and the trailing zeros of words
+	 */
+	static inline constexpr u32 popcount(u64 x) { return __builtin_popcountll(x); }
+	static inline constexpr u32 popcount(__uint128_t x) { return popcount(u64(x)) + popcount(u64(x >> 64)); }
+	static inline constexpr u32 ctz(u64 x) { return __builtin_ctzll(x); }
+	static inline constexpr u32 ctz(__uint128_t x) { return u64(x) ? ctz(u64(x)) : 64 + ctz(u64(x >> 64)); }
+
+public:
+	/**
+	 * hash this board into a 64-bit value, all the bits of zone, black, and white are mixed
+	 * each step (xorshift and multiplication with an odd number) is a bijection,
+	 * and the final avalanche is the finalizer of MurmurHash3
+	 */
+	inline constexpr u64 hash() const {
+		u64 h = fold(self().zone);
+		h = ((h ^ (h >> 31)) * 0x9e3779b97f4a7c15ull) ^ fold(self().black);
+		h = ((h ^ (h >> 31)) * 0xbf58476d1ce4e5b9ull) ^ fold(self().white);
+		h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdull;
+		h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53ull;
+		return h ^ (h >> 33);
+	}
+
+public:
+	enum PieceType {
+		ZONE_EMPTY = 0b000u, // a relevant empty location
+		ZONE_BLACK = 0b001u, // a relevant black stone
+		ZONE_WHITE = 0b010u, // a relevant white stone
+		IRRELEVANT = 0b100u, // a irrelevant piece
+	};
+	/**
+	 * get the piece at (x, y)
+	 * this function will NOT correct wrong bitmaps,
+	 * e.g., will return (ZONE_BLACK | ZONE_WHITE) when both black and white are set
+	 * @param
+	 *  x the x-axis position (A-) in decimal number [0, N)
+	 *  y the y-axis position (1-) in decimal number [0, N)
+	 * @return
+	 *  the piece at (x, y) in PieceType format
+	 */
+	inline constexpr PieceType get(u32 x, u32 y) const {
+		const Board& z = self();
+		word mask = Board::BIT_MASK(x, y);
+		return static_cast<PieceType>((z.black & mask ? 1 : 0) | (z.white & mask ? 2 : 0) | (z.zone & mask ? 0 : 4));
+	}
+	/**
+	 * set the piece at (x, y)
+	 * this function will NOT correct wrong arguments,
+	 * e.g., will set both black and white for (ZONE_BLACK | ZONE_WHITE)
+	 * @param
+	 *  x the x-axis position (A-) in decimal number [0, N)
+	 *  y the y-axis position (1-) in decimal number [0, N)
+	 *  type the PieceType to be set
+	 */
+	inline constexpr void set(u32 x, u32 y, u32 type) {
+		Board& z = self();
+		word mask = Board::BIT_MASK(x, y);
+		z.black = (type & PieceType::ZONE_BLACK) ? (z.black | mask) : (z.black & ~mask);
+		z.white = (type & PieceType::ZONE_WHITE) ? (z.white | mask) : (z.white & ~mask);
+		z.zone  = (type & PieceType::IRRELEVANT) ? (z.zone & ~mask) : (z.zone | mask);
+	}
+
+public:
+	/**
+	 * get the neighbors (up, down, left, and right) of the given locations
+	 * @param
+	 *  x the bitmap of locations
+	 * @return
+	 *  the bitmap of neighbor locations, excluding the given locations
+	 */
+	static inline constexpr word neighbors(word x) {
+		word n = (x << N) | (x >> N) | ((x & ~Board::COL_MASK(N - 1)) << 1) | ((x & ~Board::COL_MASK(0)) >> 1);
+		return n & Board::BOARD_MASK & ~x;
+	}
+	/**
+	 * flood fill the blocks (4-connected stones) that contain the given seed locations
+	 * @param
+	 *  seed   the bitmap of seed locations
+	 *  stones the bitmap of stones to be filled
+	 * @return
+	 *  the bitmap of blocks that contain any of the seeds
+	 */
+	static inline constexpr word block(word seed, word stones) {
+		word fill = seed & stones, last = 0;
+		while (fill != last) {
+			last = fill;
+			fill = (fill | neighbors(fill)) & stones;
+		}
+		return fill;
+	}
+	/**
+	 * get the relevant empty locations, note that the rules of Go are restricted to the R-zone,
+	 * i.e., only these locations are liberties and legal moves,
+	 * and the irrelevant locations are treated as if they were occupied by unknown pieces
+	 * @return
+	 *  the bitmap of relevant empty locations
+	 */
+	inline constexpr word empty() const { return self().zone & ~(self().black | self().white); }
+	/**
+	 * get the liberties of the block at (x, y)
+	 * @param
+	 *  x the x-axis position (A-) in decimal number [0, N)
+	 *  y the y-axis position (1-) in decimal number [0, N)
+	 * @return
+	 *  the bitmap of liberties, or 0 if (x, y) is not a stone
+	 */
+	inline constexpr word liberties(u32 x, u32 y) const {
+		const Board& z = self();
+		word stones = (z.black & Board::BIT_MASK(x, y)) ? z.black : ((z.white & Board::BIT_MASK(x, y)) ? z.white : 0);
+		return neighbors(block(Board::BIT_MASK(x, y), stones)) & empty();
+	}
+	/**
+	 * play a stone at (x, y) and remove the captured stones
+	 * a move is illegal if (x, y) is not a relevant empty location, is the ko location, or is a suicide
+	 * @param
+	 *  x     the x-axis position (A-) in decimal number [0, N)
+	 *  y     the y-axis position (1-) in decimal number [0, N)
+	 *  color the color of the stone, either ZONE_BLACK or ZONE_WHITE
+	 *  ko    the location forbidden by the ko rule, will be updated after a legal move
+	 * @return
+	 *  whether the move is legal, the board is NOT modified if the move is illegal
+	 */
+	inline constexpr bool play(u32 x, u32 y, u32 color, word& ko) {
+		Board& z = self();
+		const word move = Board::BIT_MASK(x, y);
+		if (!(empty() & ~ko & move)) return false;
+		word& own = (color == PieceType::ZONE_WHITE) ? z.white : z.black;
+		word& opp = (color == PieceType::ZONE_WHITE) ? z.black : z.white;
+
+		word mine = own | move;
+		word adjacent = block(neighbors(move) & opp, opp);
+		word space = z.zone & ~(mine | opp);
+		word captured = adjacent & ~block(neighbors(space) & adjacent, adjacent);
+		space |= captured;
+		word group = block(move, mine);
+		if (!(neighbors(group) & space)) return false; // suicide
+
+		own = mine;
+		opp &= ~captured;
+		// a single stone that captures a single stone and has only one liberty can be recaptured immediately
+		bool single = (group == move) & (popcount(captured) == 1) & ((neighbors(move) & space) == captured);
+		ko = single ? captured : 0;
+		return true;
+	}
+	/**
+	 * play a stone at (x, y) and remove the captured stones, without considering ko
+	 * see play(x, y, color, ko) for the details
+	 */
+	inline constexpr bool play(u32 x, u32 y, u32 color) {
+		word ko = 0;
+		return play(x, y, color, ko);
+	}
+	/**
+	 * check whether playing a stone at (x, y) is legal
+	 * see play(x, y, color, ko) for the details
+	 */
+	inline constexpr bool legal(u32 x, u32 y, u32 color, word ko = 0) const {
+		Board z = self();
+		return z.play(x, y, color, ko);
+	}
+	/**
+	 * generate all legal moves in the R-zone
+	 * @param
+	 *  color the color to play, either ZONE_BLACK or ZONE_WHITE
+	 *  ko    the location forbidden by the ko rule
+	 * @return
+	 *  the bitmap of legal moves
+	 */
+	inline constexpr word legal_moves(u32 color, word ko = 0) const {
+		word space = empty();
+		word moves = space & ~ko & neighbors(space); // a move next to an empty location is never a suicide
+		for (word rest = space & ~ko & ~moves; rest; rest &= rest - 1) {
+			u32 i = ctz(rest);
+			if (legal(i % N, i / N, color)) moves |= rest & -rest;
+		}
+		return moves;
+	}
+	/**
+	 * check whether this board is a valid position, i.e., every block has at least one liberty
+	 */
+	inline constexpr bool valid() const {
+		const Board& z = self();
+		word space = neighbors(empty());
+		return (block(space & z.black, z.black) == z.black) & (block(space & z.white, z.white) == z.white);
+	}
+
+public:
+	/**
+	 * transform this board to a specific isomorphic form
+	 * @param
+	 *  i the isomorphic id number: [0, 8)
+	 */
+	inline constexpr void transform(u32 i) {
+		Board& z = self();
+		z.zone = Isomorphisms::transform(z.zone, i);
+		z.black = Isomorphisms::transform(z.black, i);
+		z.white = Isomorphisms::transform(z.white, i);
+	}
+
+public:
+	struct Isomorphisms;
+	/**
+	 * the transformation applied by canonicalize(), i.e., transform(iso) followed by a right shift of slide()
+	 */
+	struct Transformation {
+		u32 iso;     // the isomorphic id number: [0, 8)
+		u32 inverse; // the isomorphic id number that reverts iso
+		u32 shift;   // the right shift of slide(), or 0 if slide() is not allowed
+
+		/**
+		 * map a bitmap (e.g., moves) from the original orientation to the canonical one
+		 */
+		inline constexpr word apply(word x) const { return Isomorphisms::transform(x, iso) >> shift; }
+		/**
+		 * map a bitmap (e.g., moves) from the canonical orientation back to the original one
+		 */
+		inline constexpr word restore(word x) const { return Isomorphisms::transform(x << shift, inverse); }
+	};
+	/**
+	 * normalize this board to the minimal isomorphisms, the result is identical to normalize()
+	 * the minimal isomorphisms of zone are found first, so that black and white are transformed only once,
+	 * or only for the ties of a symmetric zone
+	 * @param
+	 *  allow_slide set as true to invoke slide() for all isomorphisms, default is false
+	 * @return
+	 *  the applied transformation, the smallest isomorphic id number if there are multiple minimal isomorphisms
+	 */
+	inline constexpr Transformation canonicalize(bool allow_slide = false) {
+		Board& board = self();
+		Isomorphisms isoz = board.zone;
+		u32 shift[8] = {}, ties = 1;
+		word min = isoz[0];
+		if (allow_slide) min >>= (shift[0] = Board::slide_offset(min));
+		for (u32 i = 1; i < 8; i++) {
+			word z = isoz[i];
+			if (allow_slide) z >>= (shift[i] = Board::slide_offset(z));
+			if (z < min) min = z, ties = 0;
+			ties |= (z == min) ? (1u << i) : 0;
+		}
+		u32 best = __builtin_ctz(ties);
+		if (ties == (1u << best)) { // an asymmetric zone, the usual case
+			board = { min, Isomorphisms::transform(board.black, best) >> shift[best], Isomorphisms::transform(board.white, best) >> shift[best] };
+		} else if (__builtin_popcount(ties) == 2) { // a zone with a single symmetry, compare both without branches
+			u32 next = __builtin_ctz(ties & (ties - 1));
+			word b0 = board.black, w0 = board.white, b1 = board.black, w1 = board.white;
+			Isomorphisms::transform(b0, w0, best);
+			Isomorphisms::transform(b1, w1, next);
+			Board first(min, b0 >> shift[best], w0 >> shift[best]), second(min, b1 >> shift[next], w1 >> shift[next]);
+			bool swap = second < first;
+			board = swap ? second : first;
+			best = swap ? next : best;
+		} else { // a zone with 4 or 8 symmetries
+			Isomorphisms isob = board.black, isow = board.white;
+			board = { min, isob[best] >> shift[best], isow[best] >> shift[best] };
+			for (u32 i = best + 1; i < 8; i++) {
+				Board iso(isoz[i] >> shift[i], isob[i] >> shift[i], isow[i] >> shift[i]);
+				if (iso < board) board = iso, best = i;
+			}
+		}
+		return { best, Isomorphisms::inverse(best), shift[best] };
+	}
+
+public:
+	/**
+	 * generate all isomorphisms of a given board by flip/transpose consecutively
+	 * note that the output of transform(x, i) is the ith isomorphism in iso[], i.e., Isomorphisms(x)[i]
+	 * transform(x, i) may be more efficient when only several isomorphisms are needed
+	 */
+	struct Isomorphisms {
+		word iso[8];
+		inline constexpr Isomorphisms(word x) : iso{} {
+			iso[0] = x;
+			iso[1] = Board::flip(iso[0]);
+			iso[2] = Board::transpose(iso[1]);
+			iso[3] = Board::flip(iso[2]);
+			iso[4] = Board::transpose(iso[3]);
+			iso[5] = Board::flip(iso[4]);
+			iso[6] = Board::transpose(iso[5]);
+			iso[7] = Board::flip(iso[6]);
+		}
+		static inline constexpr word transform(word x, u32 i) {
+			switch (i % 8) {
+			default:
+			case 0: return x;
+			case 6: x = Board::transpose(x);
+			case 1: x = Board::flip(x);
+			        return x;
+			case 4: x = Board::flip(x);
+			case 5: x = Board::mirror(x);
+			        return x;
+			case 3: x = Board::mirror(x);
+			case 2: x = Board::flip(x);
+			case 7: x = Board::transpose(x);
+			        return x;
+			}
+		}
+		/**
+		 * transform a pair of bitmaps to the ith isomorphism without branches,
+		 * where the ith isomorphism is expressed as an optional transpose, then an optional flip, and then an optional mirror
+		 */
+		static inline constexpr void transform(word& x, word& y, u32 i) {
+			const bool t = (0b11001100u >> (i % 8)) & 1, f = (0b01011010u >> (i % 8)) & 1, m = (0b00111100u >> (i % 8)) & 1;
+			word tx = Board::transpose(x), ty = Board::transpose(y);
+			x = t ? tx : x;
+			y = t ? ty : y;
+			word fx = Board::flip(x), fy = Board::flip(y);
+			x = f ? fx : x;
+			y = f ? fy : y;
+			word mx = Board::mirror(x), my = Board::mirror(y);
+			x = m ? mx : x;
+			y = m ? my : y;
+		}
+		/**
+		 * get the isomorphic id number that reverts the ith isomorphism,
+		 * i.e., transform(transform(x, i), inverse(i)) == x
+		 * the odd ones are reflections and the 4th is the 180-degree rotation, which revert themselves,
+		 * while the 2nd and the 6th are the 90-degree rotations in opposite directions
+		 */
+		template<typename T = void>
+		static inline constexpr u32 inverse(u32 i) {
+			return Static<T>::group.inverse[i % 8];
+		}
+		/**
+		 * get the isomorphic id number of the ith isomorphism followed by the jth isomorphism,
+		 * i.e., transform(transform(x, i), j) == transform(x, compose(i, j)),
+		 * so that a chain of transformations collapses into a single transform()
+		 */
+		template<typename T = void>
+		static inline constexpr u32 compose(u32 i, u32 j) {
+			return Static<T>::group.compose[i % 8][j % 8];
+		}
+		/**
+		 * map a location (y * N + x) to its location in the ith isomorphism,
+		 * i.e., transform(1 << c, i) == 1 << map(c, i)
+		 */
+		template<typename T = void>
+		static inline constexpr u32 map(u32 c, u32 i) {
+			return Static<T>::group.cell[i % 8][c];
+		}
+
+		/**
+		 * the dihedral group of the 8 isomorphisms, which is generated from the coordinates rather than the bitmaps,
+		 * where the ith isomorphism is an optional transpose (x, y) to (y, x), then an optional flip (x, y) to (x, N - 1 - y),
+		 * and then an optional mirror (x, y) to (N - 1 - x, y), see transform(x, y, i)
+		 */
+		struct Group {
+			unsigned char cell[8][N * N]; // the location of each cell in the ith isomorphism, see map()
+			unsigned char compose[8][8];  // see compose()
+			unsigned char inverse[8];     // see inverse()
+		};
+		static inline constexpr Group generate() {
+			Group g = {};
+			for (u32 i = 0; i < 8; i++) {
+				const bool t = (0b11001100u >> i) & 1, f = (0b01011010u >> i) & 1, m = (0b00111100u >> i) & 1;
+				for (u32 c = 0; c < N * N; c++) {
+					u32 x = t ? c / N : c % N, y = t ? c % N : c / N;
+					g.cell[i][c] = (f ? N - 1 - y : y) * N + (m ? N - 1 - x : x);
+				}
+			}
+			for (u32 i = 0; i < 8; i++) {
+				for (u32 j = 0; j < 8; j++) {
+					for (u32 k = 0; k < 8; k++) {
+						bool equal = true;
+						for (u32 c = 0; c < N * N; c++) equal = equal && g.cell[k][c] == g.cell[j][g.cell[i][c]];
+						if (equal) g.compose[i][j] = k;
+					}
+					if (g.compose[i][j] == 0) g.inverse[i] = j;
+				}
+			}
+			return g;
+		}
+		template<typename = void> struct Static { static constexpr Group group = generate(); };
+
+		/**
+		 * verify that the primitives, transform(), transform(x, y, i), and Isomorphisms(x) agree with the group,
+		 * which is checked by a static_assert after ZoneBitboard<N> is complete
+		 * the inputs are the single cells, the board, the rows, the columns, and some pseudo-random bitmaps, see sample()
+		 * @return
+		 *  whether all of them agree
+		 */
+		template<typename T = void>
+		static inline constexpr bool verify() {
+			const Group& g = Static<T>::group;
+			for (u32 i = 0; i < 8; i++) {
+				for (u32 k = 0; k < SAMPLES; k++) {
+					const word x = sample(k), y = Board::BOARD_MASK ^ x;
+					word a = x, b = y;
+					transform(a, b, i);
+					if (transform(x, i) != permute<T>(x, i) || Isomorphisms(x)[i] != permute<T>(x, i)) return false;
+					if (a != permute<T>(x, i) || b != permute<T>(y, i)) return false;
+					for (u32 j = 0; j < 8; j++) {
+						if (transform(transform(x, i), j) != transform(x, g.compose[i][j])) return false;
+					}
+				}
+				if (g.compose[i][g.inverse[i]] != 0 || g.compose[g.inverse[i]][i] != 0) return false;
+			}
+			return true;
+		}
+
+	protected:
+		static constexpr u32 SAMPLES = N * N + 1 + N + N + 16;
+		/**
+		 * get the kth input of verify(): the N * N single cells, the board, the N rows, the N columns,
+		 * and then pseudo-random bitmaps from a splitmix64 sequence
+		 */
+		static inline constexpr word sample(u32 k) {
+			if (k < N * N) return word(1) << k;
+			if (k < N * N + 1) return Board::BOARD_MASK;
+			if (k < N * N + 1 + N) return Board::ROW_MASK(k - (N * N + 1));
+			if (k < N * N + 1 + N + N) return Board::COL_MASK(k - (N * N + 1 + N));
+			word x = 0;
+			for (u32 w = 0; w < sizeof(word) / sizeof(u64); w++) {
+				u64 z = 0x9e3779b97f4a7c15ull * ((k - (N * N + N + N)) * 2 + w);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+				x = (x << 32 << 32) | (z ^ (z >> 31));
+			}
+			return x & Board::BOARD_MASK;
+		}
+		/**
+		 * transform a bitmap to the ith isomorphism cell by cell, see map()
+		 */
+		template<typename T = void>
+		static inline constexpr word permute(word x, u32 i) {
+			word z = 0;
+			for (u32 c = 0; c < N * N; c++) z |= ((x >> c) & 1) << map<T>(c, i);
+			return z;
+		}
+
+	public:
+		inline constexpr word& operator[] (u32 i) { return iso[i]; }
+		inline constexpr const word& operator[] (u32 i) const { return iso[i]; }
+		inline constexpr word* begin() { return iso; }
+		inline constexpr const word* begin() const { return iso; }
+		inline constexpr word* end() { return iso + 8; }
+		inline constexpr const word* end() const { return iso + 8; }
+	};
+
+protected:
+	inline constexpr Board& self() { return static_cast<Board&>(*this); }
+	inline constexpr const Board& self() const { return static_cast<const Board&>(*this); }
+
+	static inline constexpr u64 fold(word x) {
+		return u64(x) ^ u64(x >> 32 >> 32);
+	}
+};
+
+template<unsigned int N>
+template<typename T>
+constexpr typename ZoneBitboardBase<N>::Isomorphisms::Group ZoneBitboardBase<N>::Isomorphisms::Static<T>::group;
+
+/**
+ * NxN Go bitboard with R-Zone support, for 5x5 to 9x9 boards
+ *
+ *  +-------------+
+ * 5| + + + + + | for N = 5, E5 is the highest bit, i.e., the (N * N)th low bit
+ * 4| + + + + + |
+ * 3| + + + + + |
+ * 2| + + + + + | A2 is the (N + 1)th low bit
+ * 1| + + + + + | A1 is the lowest bit
+ *  +-------------+
+ *    A B C D E
+ *
+ * the layout and the interface are the same as Zone7x7Bitboard, except that the bitmaps are words of
+ * 64 bits for N <= 8 or 128 bits for N = 9, and that the masks and the delta-swap constants of transpose(),
+ * flip(), and mirror() are generated at compile time for each N
+ * the rules, the isomorphisms, and canonicalize() are shared with Zone7x7Bitboard by ZoneBitboardBase<N>
+ *
+ * note that ZoneBitboard<7> is specialized as Zone7x7Bitboard, which keeps its hand-tuned magic numbers
+ */
+template<unsigned int N>
+class ZoneBitboard : public ZoneBitboardBase<N> {
+	friend class ZoneBitboardBase<N>;
+	using Base = ZoneBitboardBase<N>;
+public:
+	/**
+	 * common definitions, see ZoneBitboardBase
+	 */
+	using typename Base::u64;
+	using typename Base::u32;
+	using typename Base::word;
+	using typename Base::PieceType;
+	using typename Base::Isomorphisms;
+	using Base::ctz;
+
+	static constexpr word BOARD_MASK = ~word(0) >> (sizeof(word) * 8 - N * N);
+	static constexpr word ROW_MASK(u32 y) { return ((word(1) << N) - 1) << (y * N); }
+	static constexpr word COL_MASK(u32 x) { return Geometry::column() << x; }
+	static constexpr word BIT_MASK(u32 x, u32 y) { return word(1) << (y * N + x); }
+
+public:
+	/**
+	 * bitmaps are public for easy access, be careful
+	 */
+	word zone;  // zone-relevant pieces
+	word black; // black pieces in zone
+	word white; // white pieces in zone
+
+public:
+	/**
+	 * construct a bitboard with R-zone and black/white stones, see Zone7x7Bitboard
+	 */
+	inline constexpr ZoneBitboard(word zone, word black, word white) : zone(zone), black(black), white(white) {}
+	inline constexpr ZoneBitboard(word black, word white) : ZoneBitboard(BOARD_MASK, black, white) {}
+	inline constexpr ZoneBitboard() : ZoneBitboard(0, 0, 0) {}
+
+	inline constexpr ZoneBitboard(const ZoneBitboard&) = default;
+	inline constexpr ZoneBitboard& operator =(const ZoneBitboard&) = default;
+
+	inline constexpr ZoneBitboard& operator &=(const ZoneBitboard& z) { return operator =(operator &(z)); }
+	inline constexpr ZoneBitboard& operator |=(const ZoneBitboard& z) { return operator =(operator |(z)); }
+	inline constexpr ZoneBitboard& operator ^=(const ZoneBitboard& z) { return operator =(operator ^(z)); }
+	inline constexpr ZoneBitboard operator &(const ZoneBitboard& z) const { return {zone & z.zone, black & z.black, white & z.white}; }
+	inline constexpr ZoneBitboard operator |(const ZoneBitboard& z) const { return {zone | z.zone, black | z.black, white | z.white}; }
+	inline constexpr ZoneBitboard operator ^(const ZoneBitboard& z) const { return {zone ^ z.zone, black ^ z.black, white ^ z.white}; }
+	inline constexpr ZoneBitboard operator ~() const { return {~zone & BOARD_MASK, ~black & BOARD_MASK, ~white & BOARD_MASK}; }
+
+	inline constexpr ZoneBitboard& operator &=(word x) { return operator =(operator &(x)); }
+	inline constexpr ZoneBitboard& operator |=(word x) { return operator =(operator |(x)); }
+	inline constexpr ZoneBitboard& operator ^=(word x) { return operator =(operator ^(x)); }
+	inline constexpr ZoneBitboard& operator <<=(u32 i) { return operator =(operator <<(i)); }
+	inline constexpr ZoneBitboard& operator >>=(u32 i) { return operator =(operator >>(i)); }
+	inline constexpr ZoneBitboard operator &(word x) const { return {zone & x, black & x, white & x}; }
+	inline constexpr ZoneBitboard operator |(word x) const { return {zone | x, black | x, white | x}; }
+	inline constexpr ZoneBitboard operator ^(word x) const { return {zone ^ x, black ^ x, white ^ x}; }
+	inline constexpr ZoneBitboard operator <<(u32 i) const { return {zone << i, black << i, white << i}; }
+	inline constexpr ZoneBitboard operator >>(u32 i) const { return {zone >> i, black >> i, white >> i}; }
+
+	inline constexpr bool operator ==(const ZoneBitboard& z) const { return (zone == z.zone) & (black == z.black) & (white == z.white); }
+	inline constexpr bool operator < (const ZoneBitboard& z) const {
+		return (zone != z.zone) ? (zone < z.zone) : ((black != z.black) ? (black < z.black) : (white < z.white));
+	}
+	inline constexpr bool operator !=(const ZoneBitboard& z) const { return !(*this == z); }
+	inline constexpr bool operator > (const ZoneBitboard& z) const { return  (z < *this); }
+	inline constexpr bool operator <=(const ZoneBitboard& z) const { return !(z < *this); }
+	inline constexpr bool operator >=(const ZoneBitboard& z) const { return !(*this < z); }
+
+public:
+	/**
+	 * transpose, flip, or mirror this board, see Zone7x7Bitboard
+	 */
+	inline constexpr void transpose() {
+		zone = transpose(zone);
+		black = transpose(black);
+		white = transpose(white);
+	}
+	inline constexpr void flip() {
+		zone = flip(zone);
+		black = flip(black);
+		white = flip(white);
+	}
+	inline constexpr void mirror() {
+		zone = mirror(zone);
+		black = mirror(black);
+		white = mirror(white);
+	}
+
+public:
+	/**
+	 * slide all the pieces as close to the origin (A1) as possible, see Zone7x7Bitboard::slide()
+	 */
+	inline constexpr void slide() {
+		*this >>= slide_offset(zone);
+	}
+	/**
+	 * normalize this board to the minimal isomorphisms, see ZoneBitboardBase::canonicalize()
+	 */
+	inline constexpr void normalize(bool allow_slide = false) {
+		this->canonicalize(allow_slide);
+	}
+
+protected:
+	/**
+	 * the delta-swap masks of transpose(), flip(), and mirror()
+	 *
+	 * transpose() swaps (x, y) and (y, x) for each x - y = k in [1, N), which are (k * (N - 1)) bits apart,
+	 * flip() swaps row y and row (N - 1 - y) for each y < N / 2, which are ((N - 1 - 2y) * N) bits apart,
+	 * mirror() swaps column x and column (N - 1 - x) for each x < N / 2, which are (N - 1 - 2x) bits apart,
+	 * where each mask selects the lower bits of the pairs
+	 */
+	struct Geometry {
+		word transpose[N];
+		word flip[N / 2];
+		word mirror[N / 2];
+
+		static inline constexpr word column() {
+			word m = 0;
+			for (u32 y = 0; y < N; y++) m |= word(1) << (y * N);
+			return m;
+		}
+		static inline constexpr Geometry generate() {
+			Geometry g = {};
+			for (u32 y = 0; y < N; y++) {
+				for (u32 x = y + 1; x < N; x++) g.transpose[x - y] |= BIT_MASK(x, y);
+			}
+			for (u32 i = 0; i < N / 2; i++) {
+				g.flip[i] = ROW_MASK(i);
+				g.mirror[i] = column() << i;
+			}
+			return g;
+		}
+	};
+	template<typename = void> struct Static { static constexpr Geometry geometry = Geometry::generate(); };
+
+	static inline constexpr word delta_swap(word x, word mask, u32 delta) {
+		word t = ((x >> delta) ^ x) & mask;
+		return x ^ t ^ (t << delta);
+	}
+
+	/**
+	 * calculate the right shift of slide() for the given zone
+	 * as Zone7x7Bitboard::slide_offset(), an empty zone is shifted by (N - 1) rows and (N - 1) columns
+	 */
+	static inline constexpr u32 slide_offset(word zone) {
+		u32 offset = 0;
+		if (!(zone & ROW_MASK(N - 1))) {
+			offset += (((zone ? ctz(zone) : N * N) / N ?: 1) - 1) * N;
+		}
+		if (!(zone & COL_MASK(N - 1))) {
+			word squz = 0;
+			for (u32 y = 0; y < N; y++) squz |= zone >> (y * N);
+			squz &= ROW_MASK(0);
+			offset += ((squz ? ctz(squz) : N) ?: 1) - 1;
+		}
+		return offset;
+	}
+	/**
+	 * transpose a given NxN board (reflection line is A1 - the top-right corner) with (N - 1) delta swaps
+	 */
+	static inline constexpr word transpose(word x) {
+		const Geometry& g = Static<>::geometry;
+		for (u32 k = 1; k < N; k++) x = delta_swap(x, g.transpose[k], k * (N - 1));
+		return x;
+	}
+	/**
+	 * flip a given NxN board (reflection line is the middle row) with (N / 2) delta swaps
+	 */
+	static inline constexpr word flip(word x) {
+		const Geometry& g = Static<>::geometry;
+		for (u32 i = 0; i < N / 2; i++) x = delta_swap(x, g.flip[i], (N - 1 - 2 * i) * N);
+		return x;
+	}
+	/**
+	 * mirror a given NxN board (reflection line is the middle column) with (N / 2) delta swaps
+	 */
+	static inline constexpr word mirror(word x) {
+		const Geometry& g = Static<>::geometry;
+		for (u32 i = 0; i < N / 2; i++) x = delta_swap(x, g.mirror[i], N - 1 - 2 * i);
+		return x;
+	}
+
+public:
+	/**
+	 * print the given board to the given ostream with a single write, in the same style as Zone7x7Bitboard
+	 */
+	friend std::ostream& operator <<(std::ostream& out, const ZoneBitboard& z) {
+		const bool axis = true; // whether to print axis labels (A-J without I, 1-9)
+
+		const char* symbol[] = {"\u00B7", "\u25CF", "\u25CB", "\u00A0"}; // empty  black  white  irrelevant
+		const char* corner[] = {"\u250C", "\u250F", "\u2510", "\u2513",  // top-left{normal, bold}  top-right{normal, bold}
+		                        "\u2514", "\u2517", "\u2518", "\u251B"}; // bottom-left{normal, bold}  bottom-right{normal, bold}
+		const char* border[] = {"\u2500", "\u2501", "\u2502", "\u2503"}; // horizontal{normal, bold}  vertical{normal, bold}
+		const char* label = "ABCDEFGHJ";
+
+		// gather r-zone info
+		bool zone[N][N] = {};
+		for (u32 y = 0; y < N; y++) {
+			for (u32 x = 0; x < N; x++) {
+				zone[x][y] = (z.get(x, y) & PieceType::IRRELEVANT) != PieceType::IRRELEVANT;
+			}
+		}
+
+		std::string text;
+		// append the top (k = 0) or the bottom (k = 4) border of row y
+		auto edge = [&](u32 y, u32 k) {
+			text.append(axis ? " " : "").append(corner[k + zone[0][y]]);
+			for (u32 last = zone[0][y], x = 0; x < N; last = zone[x++][y]) {
+				text.append(border[zone[x][y] | last]).append(border[zone[x][y]]);
+			}
+			text.append(border[zone[N - 1][y]]).append(corner[k + 2 + zone[N - 1][y]]).append("\n");
+		};
+
+		edge(N - 1, 0);
+		for (u32 y = N; y-- > 0; ) {
+			if (axis) text.push_back(char('1' + y));
+			text.append(border[2 + zone[0][y]]).append(" ");
+			for (u32 x = 0; x < N; x++) {
+				text.append(symbol[std::min<u32>(z.get(x, y), 3)]).append(" ");
+			}
+			text.append(border[2 + zone[N - 1][y]]).append("\n");
+		}
+		edge(0, 4);
+		if (axis) {
+			text.append("  ");
+			for (u32 x = 0; x < N; x++) text.append(" ").push_back(label[x]);
+			text.append("  \n");
+		}
+		return out.write(text.data(), text.size());
+	}
+};
+
+template<unsigned int N>
+constexpr typename ZoneBitboard<N>::word ZoneBitboard<N>::BOARD_MASK;
+template<unsigned int N>
+template<typename T>
+constexpr typename ZoneBitboard<N>::Geometry ZoneBitboard<N>::Static<T>::geometry;
+
+namespace std {
+template<unsigned int N> struct hash<ZoneBitboard<N>> {
+	inline constexpr size_t operator ()(const ZoneBitboard<N>& z) const { return z.hash(); }
+};
+}
+
+/**
+ * a helper written only against the interface of ZoneBitboard<N>, which is instantiated by a static_assert
+ * after Zone7x7Bitboard for both N = 5 and N = 7, so that the specialization keeps the same interface as the template
+ * @return
+ *  whether a capture at A1 and canonicalize() of a corner zone give the expected results
+ */
+template<unsigned int N>
+inline constexpr bool zone_bitboard_check() {
+	using Board = ZoneBitboard<N>;
+	using word = typename Board::word;
+	if (Board::SIZE != N || Board::popcount(Board::BOARD_MASK) != N * N || Board::ctz(Board::ROW_MASK(1)) != N) return false;
+
+	// black at A2 captures white at A1, where white cannot play back since it is a suicide
+	Board z(Board::BIT_MASK(1, 0), Board::BIT_MASK(0, 0));
+	word ko = 0;
+	if (!z.play(0, 1, Board::ZONE_BLACK, ko) || z.white || ko || z.get(0, 0) != Board::ZONE_EMPTY) return false;
+	if (Board::popcount(z.liberties(0, 1)) != 3 || !z.valid() || z.legal_moves(Board::ZONE_WHITE) != (z.empty() & ~Board::BIT_MASK(0, 0))) return false;
+
+	// the two cells at the top-right corner are rotated to A1 and B1, and slide() keeps them there
+	Board c(Board::BIT_MASK(N - 1, N - 1) | Board::BIT_MASK(N - 2, N - 1), Board::BIT_MASK(N - 1, N - 1), 0);
+	const typename Board::Transformation t = c.canonicalize(true);
+	if (c.zone != 0b11 || c.black != 0b01 || c.white || t.shift || t.restore(c.black) != Board::BIT_MASK(N - 1, N - 1)) return false;
+	if (t.apply(Board::BIT_MASK(N - 2, N - 1)) != 0b10 || Board::Isomorphisms::compose(t.iso, t.inverse) != 0) return false;
+
+	// an empty zone is slid by (N - 1) rows and (N - 1) columns
+	Board e;
+	if (e.canonicalize(true).shift != (N - 1) * N + N - 1) return false;
+
+	// the group API
+	for (unsigned int i = 0; i < 8; i++) {
+		word x = Board::BIT_MASK(1, 0) | Board::BIT_MASK(2, 3), y = Board::BOARD_MASK ^ x;
+		Board::Isomorphisms::transform(x, y, i);
+		if (x != (Board::BIT_MASK(0, 0) << Board::Isomorphisms::map(1, i) | Board::BIT_MASK(0, 0) << Board::Isomorphisms::map(3 * N + 2, i))) return false;
+		if (y != (Board::BOARD_MASK ^ x) || Board::Isomorphisms::transform(x, Board::Isomorphisms::inverse(i)) != (Board::BIT_MASK(1, 0) | Board::BIT_MASK(2, 3))) return false;
+	}
+	return true;
+}
+
+#include "Zone7x7Bitboard.h" // the specialization of ZoneBitboard<7>